@@ -0,0 +1,176 @@
+/**
+ * @file copy_bench.c
+ * @brief Compares memcpy(), fbdev_copy_stream() and a plain loop for framebuffer-sized copies.
+ *
+ * The destination is a cached malloc() buffer and, when a device is given, a shared mapping of it
+ * (e.g. /dev/fb0, which is write-combined or uncached), so the copy can be chosen per board with
+ * FBDEV_COPY_STREAM. Sizes are one 320 pixel RGB565 row (also at a misaligned address),
+ * a 24 line strip and a full 320x240 frame.
+ *
+ * Usage: copy_bench [ITERATIONS] [DEVICE]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/fb.h>
+#endif
+#include "lv_drivers/display/fbdev_copy.h"
+
+#define ROW_BYTES (320 * 2)
+#define FRAME_BYTES (320 * 240 * 2)
+#define DEFAULT_ITERATIONS 2000
+
+typedef void (*copy_fn_t)(void * dst, const void * src, size_t n);
+
+typedef struct {
+    const char * name;
+    size_t offset;  // Destination offset: 2 keeps RGB565 pixels aligned but not the row
+    size_t bytes;
+} bench_size_t;
+
+// --- Copies ---
+static void libc_memcpy(void * dst, const void * src, size_t n) {
+    memcpy(dst, src, n);
+}
+
+// Pixel by pixel like the old flush loops; GCC must not turn it back into a memcpy() call
+#if defined(__GNUC__) && !defined(__clang__)
+__attribute__((optimize("no-tree-loop-distribute-patterns")))
+#endif
+static void plain_loop(void * dst, const void * src, size_t n) {
+    uint16_t * d = dst;
+    const uint16_t * s = src;
+    for (size_t i = 0; i < n / 2; i++) d[i] = s[i];
+}
+
+// --- Helper Functions ---
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Returns MB/s
+static double bench(copy_fn_t fn, uint8_t * dst, const uint8_t * src, size_t bytes, int iterations) {
+    fn(dst, src, bytes);   // Warm up
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < iterations; i++) fn(dst, src, bytes);
+    double ns = (double)(now_ns() - t0);
+    return ns > 0 ? (double)bytes * iterations * 1e3 / ns : 0;
+}
+
+// Returns the number of failed cases
+static int check_copy(uint8_t * dst, const uint8_t * src, size_t len) {
+    static const size_t sizes[] = {0, 1, 15, 127, 128, 129, 640, 1001, 4096 + 3};
+    int failed = 0;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (size_t ofs = 0; ofs < 16; ofs++) {
+            size_t n = sizes[s];
+            if (ofs + n + 1 > len) continue;
+            memset(dst, 0xA5, ofs + n + 1);
+            fbdev_copy_stream(dst + ofs, src + 3, n);
+            if (memcmp(dst + ofs, src + 3, n) != 0 || dst[ofs + n] != 0xA5 || (ofs && dst[ofs - 1] != 0xA5)) {
+                fprintf(stderr, "Mismatch: %zu bytes at offset %zu\n", n, ofs);
+                failed++;
+            }
+        }
+    }
+    return failed;
+}
+
+// Maps the whole device or file; returns NULL on failure
+static uint8_t * map_device(const char * path, size_t * len) {
+    int fd = open(path, O_RDWR);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    *len = 0;
+#ifdef __linux__
+    struct fb_fix_screeninfo finfo;
+    if (ioctl(fd, FBIOGET_FSCREENINFO, &finfo) == 0) *len = finfo.smem_len;
+#endif
+    if (*len == 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0) *len = (size_t)st.st_size;
+    }
+    uint8_t * p = *len ? mmap(NULL, *len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s\n", path);
+        return NULL;
+    }
+    return p;
+}
+
+static void run(const char * name, uint8_t * dst, size_t len, const uint8_t * src, int iterations) {
+    static const bench_size_t sizes[] = {
+        {"row 640 B", 0, ROW_BYTES},
+        {"row 640 B @2", 2, ROW_BYTES},
+        {"strip 30 KiB", 0, ROW_BYTES * 24},
+        {"frame 150 KiB", 0, FRAME_BYTES},
+    };
+    printf("%s\n", name);
+    printf("  %-14s %12s %12s %12s\n", "size", "memcpy", "fbdev_copy", "plain loop");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        const bench_size_t * sz = &sizes[i];
+        if (sz->offset + sz->bytes > len) continue;
+        // Fewer rounds for bigger copies so every row takes a similar time
+        int n = (int)((uint64_t)iterations * ROW_BYTES * 8 / (sz->bytes + ROW_BYTES * 7));
+        if (n < 1) n = 1;
+        uint8_t * d = dst + sz->offset;
+        printf("  %-14s %12.1f %12.1f %12.1f\n", sz->name,
+               bench(libc_memcpy, d, src, sz->bytes, n),
+               bench(fbdev_copy_stream, d, src, sz->bytes, n),
+               bench(plain_loop, d, src, sz->bytes, n));
+    }
+}
+
+int main(int argc, char ** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) iterations = DEFAULT_ITERATIONS;
+    const char * device = argc > 2 ? argv[2] : NULL;
+
+    uint8_t * src = malloc(FRAME_BYTES);
+    uint8_t * ram = malloc(FRAME_BYTES + 64);
+    if (!src || !ram) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < FRAME_BYTES; i++) src[i] = (uint8_t)rand();
+
+    int failed = check_copy(ram, src, FRAME_BYTES + 64);
+
+    printf("%d iterations per row, MB/s, fbdev_copy: %s\n", iterations, fbdev_copy_impl_name());
+    run("cached (malloc)", ram, FRAME_BYTES + 64, src, iterations);
+
+    if (device) {
+        size_t len;
+        uint8_t * map = map_device(device, &len);
+        if (map) {
+            char name[128];
+            snprintf(name, sizeof(name), "mapped (%s, %zu bytes)", device, len);
+            run(name, map, len, src, iterations);
+            munmap(map, len);
+        }
+        else {
+            failed++;
+        }
+    }
+
+    free(src);
+    free(ram);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,234 @@
+/**
+ * @file flush_bench.c
+ * @brief Throughput of the fbdev_flush() pixel paths against a memory-backed framebuffer.
+ *
+ * fbdev maps a plain file (fbdev_set_file()) with synthetic screen info, so the numbers only
+ * depend on the CPU and memory and can be compared from build to build. Each case pushes a
+ * full frame in 24 line strips, the way LVGL flushes with a 10% draw buffer, and a 300x30
+ * area, the size of a menu button repainted on a focus move.
+ * Page flipping needs FBIOPAN_DISPLAY and is not covered; neither are 8 bpp screens, which
+ * need 8 bit LVGL colours while the bench renders 16 bit ones.
+ *
+ * Usage: flush_bench [ITERATIONS] [SPEC]
+ *   SPEC is PATH,WxH,BPP[,stride=BYTES][,xoffset=N][,yoffset=N][,bgr] like --fb-file; all
+ *   transforms are then run on that geometry instead of the built-in formats.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "lvgl/lvgl.h"
+#include "lv_drivers/display/fbdev.h"
+
+#define UI_W 320
+#define UI_H 240
+#define STRIP_LINES 24
+#define BUTTON_W 300
+#define BUTTON_H 30
+#define DEFAULT_ITERATIONS 200
+#define DEFAULT_PATH "/dev/shm/flush_bench.fb"
+
+typedef struct {
+    const char * name;
+    uint32_t bpp;
+    bool bgr;
+    uint32_t scale;           // Screen is UI_W*scale x UI_H*scale
+    uint32_t rotation;        // Degrees
+    bool shadow;
+    bool shadow_changes;      // Alternate two pictures so the shadow finds something to write
+} bench_case_t;
+
+static const bench_case_t cases[] = {
+    {"RGB565",          16, false, 1, 0,   false, false},
+    {"BGR565",          16, true,  1, 0,   false, false},
+    {"XRGB8888",        32, false, 1, 0,   false, false},
+    {"XBGR8888",        32, true,  1, 0,   false, false},
+    {"RGB888",          24, false, 1, 0,   false, false},
+    {"BGR888",          24, true,  1, 0,   false, false},
+    {"1 bpp",           1,  false, 1, 0,   false, false},
+    {"RGB565 rot 90",   16, false, 1, 90,  false, false},
+    {"RGB565 rot 180",  16, false, 1, 180, false, false},
+    {"RGB565 rot 270",  16, false, 1, 270, false, false},
+    {"XRGB8888 rot 90", 32, false, 1, 90,  false, false},
+    {"RGB565 x2",       16, false, 2, 0,   false, false},
+    {"XRGB8888 x2",     32, false, 2, 0,   false, false},
+    {"XRGB8888 x3",     32, false, 3, 0,   false, false},
+    {"RGB565 shadow =", 16, false, 1, 0,   true,  false},
+    {"RGB565 shadow",   16, false, 1, 0,   true,  true},
+};
+
+// Transforms applied to a geometry given on the command line
+static const bench_case_t spec_cases[] = {
+    {"plain",   0, false, 1, 0,   false, false},
+    {"rot 90",  0, false, 1, 90,  false, false},
+    {"rot 180", 0, false, 1, 180, false, false},
+    {"rot 270", 0, false, 1, 270, false, false},
+    {"x2",      0, false, 2, 0,   false, false},
+    {"shadow",  0, false, 1, 0,   true,  true},
+};
+
+static lv_disp_drv_t drv;
+static lv_disp_draw_buf_t draw_buf;
+static size_t pic_px;         // Pixels in each source picture
+
+// --- Helper Functions ---
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void flush(int32_t x1, int32_t y1, int32_t x2, int32_t y2, lv_color_t * color_p, bool last) {
+    lv_area_t area = {x1, y1, x2, y2};
+    draw_buf.flushing = 1;
+    draw_buf.flushing_last = last;
+    fbdev_flush(&drv, &area, color_p);
+}
+
+// One frame in strips; returns the pixels flushed
+static uint64_t push_frame(lv_color_t * pic, uint32_t w, uint32_t h) {
+    for (uint32_t y1 = 0; y1 < h; y1 += STRIP_LINES) {
+        uint32_t y2 = y1 + STRIP_LINES > h ? h - 1 : y1 + STRIP_LINES - 1;
+        flush(0, y1, w - 1, y2, pic + y1 * w, y2 == h - 1);
+    }
+    return (uint64_t)w * h;
+}
+
+static uint64_t push_button(lv_color_t * pic, uint32_t w, uint32_t h) {
+    uint32_t bw = w < BUTTON_W ? w : BUTTON_W;
+    uint32_t bh = h < BUTTON_H ? h : BUTTON_H;
+    uint32_t x1 = (w - bw) / 2, y1 = (h - bh) / 2;
+    flush(x1, y1, x1 + bw - 1, y1 + bh - 1, pic, true);
+    return (uint64_t)bw * bh;
+}
+
+typedef uint64_t (*push_fn_t)(lv_color_t * pic, uint32_t w, uint32_t h);
+
+// Returns ns per pixel
+static double bench(push_fn_t fn, lv_color_t * pics[2], bool alternate, uint32_t w, uint32_t h, int iterations) {
+    fn(pics[0], w, h);   // Warm up (and fill the shadow)
+    uint64_t px = 0;
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < iterations; i++) px += fn(pics[alternate ? (i + 1) & 1 : 0], w, h);
+    return px ? (double)(now_ns() - t0) / px : 0;
+}
+
+// Returns false if the framebuffer could not be set up
+static bool run_case(const bench_case_t * c, const fbdev_file_t * geometry, lv_color_t * pics[2], int iterations) {
+    fbdev_file_t f = *geometry;
+    if (c->bpp) {
+        f.bits_per_pixel = c->bpp;
+        f.bgr = c->bgr;
+        f.xres = UI_W * c->scale;
+        f.yres = UI_H * c->scale;
+        // Rows padded to 64 bytes, like most display controllers want
+        f.line_length = ((f.xres * f.bits_per_pixel + 7) / 8 + 63) & ~63u;
+    }
+
+    fbdev_set_file(&f);
+    fbdev_set_shadow(c->shadow);
+    fbdev_set_rotation(fbdev_rotation_from_degrees(c->rotation));
+    fbdev_init();
+    if (fbdev_get_screen_bytes() == 0) return false;
+    if (strcmp(fbdev_get_pipeline(), "unsupported") == 0) {
+        printf("%-16s %-30s %s\n", c->name, "-", "(no flush path for this format)");
+        fbdev_exit();
+        return true;
+    }
+
+    uint32_t w, h;
+    fbdev_get_sizes(&w, &h);
+    if (c->rotation == 90 || c->rotation == 270) {
+        uint32_t tmp = w;
+        w = h;
+        h = tmp;
+    }
+    if (c->scale > 1) {
+        uint32_t s = fbdev_set_scale(w / c->scale, h / c->scale, c->scale);
+        if (s != c->scale) {
+            printf("%-16s %-30s %s\n", c->name, fbdev_get_pipeline(), "(cannot scale)");
+            fbdev_exit();
+            return true;
+        }
+        w /= c->scale;
+        h /= c->scale;
+    } else {
+        fbdev_set_scale(w, h, 1);
+    }
+    if ((size_t)w * h > pic_px) {
+        printf("%-16s %-30s %s\n", c->name, fbdev_get_pipeline(), "(screen too large)");
+        fbdev_exit();
+        return true;
+    }
+    fbdev_prepare(w * h);
+
+    double frame_ns = bench(push_frame, pics, c->shadow_changes, w, h, iterations);
+    double button_ns = bench(push_button, pics, c->shadow_changes, w, h, iterations * 10);
+    // MB/s of LVGL pixels handed to the flush
+    printf("%-16s %-30s %8.3f %8.1f %8.3f %8.1f\n", c->name, fbdev_get_pipeline(),
+           frame_ns, sizeof(lv_color_t) * 1e3 / frame_ns, button_ns, sizeof(lv_color_t) * 1e3 / button_ns);
+    fbdev_exit();
+    return true;
+}
+
+int main(int argc, char ** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) iterations = DEFAULT_ITERATIONS;
+
+    fbdev_file_t geometry;
+    const bench_case_t * list = cases;
+    size_t cnt = sizeof(cases) / sizeof(cases[0]);
+    if (argc > 2) {
+        if (!fbdev_file_parse(argv[2], &geometry)) {
+            fprintf(stderr, "Invalid framebuffer spec: %s\n", argv[2]);
+            return 1;
+        }
+        list = spec_cases;
+        cnt = sizeof(spec_cases) / sizeof(spec_cases[0]);
+    } else {
+        memset(&geometry, 0, sizeof(geometry));
+        snprintf(geometry.path, sizeof(geometry.path), "%s", DEFAULT_PATH);
+    }
+
+    lv_init();
+    lv_disp_drv_init(&drv);
+    drv.draw_buf = &draw_buf;
+
+    // Big enough for the 3x cases and for the SPEC's screen
+    size_t px = (size_t)UI_W * UI_H * 9;
+    if (argc > 2 && (size_t)geometry.xres * geometry.yres > px) px = (size_t)geometry.xres * geometry.yres;
+    pic_px = px;
+    lv_color_t * pics[2] = {malloc(px * sizeof(lv_color_t)), malloc(px * sizeof(lv_color_t))};
+    if (!pics[0] || !pics[1]) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < px; i++) {
+        pics[0][i].full = (uint16_t)rand();
+        pics[1][i].full = (uint16_t)rand();
+    }
+
+    printf("%d iterations, frames in %d line strips and one %dx%d area (ns/pixel, MB/s of %d bit colours)\n",
+           iterations, STRIP_LINES, BUTTON_W, BUTTON_H, LV_COLOR_DEPTH);
+    printf("%-16s %-30s %17s %17s\n", "case", "pipeline", "frame", "button");
+    int failed = 0;
+    for (size_t i = 0; i < cnt; i++) {
+        if (!run_case(&list[i], &geometry, pics, iterations)) {
+            fprintf(stderr, "Cannot map %s\n", geometry.path);
+            failed++;
+            break;
+        }
+    }
+
+    fbdev_set_file(NULL);
+    if (argc <= 2) unlink(DEFAULT_PATH);
+    free(pics[0]);
+    free(pics[1]);
+    return failed ? 1 : 0;
+}
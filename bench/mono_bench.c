@@ -0,0 +1,113 @@
+/**
+ * @file mono_bench.c
+ * @brief Throughput of the 1 bpp framebuffer path: the old per-pixel loop against the packed rows.
+ *
+ * The old loop is the former bits_per_pixel == 1 branch of fbdev_flush(): a read-modify-write of
+ * one bit per pixel, indexed with xres, storing the low bits of the colour value.
+ * Areas are a full 320x240 frame and 24 line strips starting at an odd column.
+ *
+ * Usage: mono_bench [ITERATIONS]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "lv_drivers/display/fbdev_pixconv.h"
+
+#define SCREEN_W 320
+#define SCREEN_H 240
+#define LINE_LENGTH (SCREEN_W / 8)
+#define DEFAULT_ITERATIONS 500
+
+typedef struct {
+    const char * name;
+    int32_t x1, y1, x2, y2;
+} bench_area_t;
+
+typedef void (*mono_flush_t)(uint8_t * fb, const bench_area_t * a, const uint16_t * color_p, uint32_t flags);
+
+// --- Flush Paths ---
+static void old_loop(uint8_t * fb, const bench_area_t * a, const uint16_t * color_p, uint32_t flags) {
+    for (int32_t y = a->y1; y <= a->y2; y++) {
+        for (int32_t x = a->x1; x <= a->x2; x++) {
+            long int location = x + y * SCREEN_W;
+            long int byte_location = location / 8;
+            unsigned char bit_location = location % 8;
+            fb[byte_location] &= ~(((uint8_t)(1)) << bit_location);
+            fb[byte_location] |= ((uint8_t)(*color_p)) << bit_location;
+            color_p++;
+        }
+    }
+}
+
+static void packed_rows(uint8_t * fb, const bench_area_t * a, const uint16_t * color_p, uint32_t flags) {
+    uint32_t w = a->x2 - a->x1 + 1;
+    uint8_t * row = fb + a->y1 * LINE_LENGTH;
+    for (int32_t y = a->y1; y <= a->y2; y++) {
+        fbdev_pixconv_mono_row(row, color_p, a->x1, w, y, flags);
+        row += LINE_LENGTH;
+        color_p += w;
+    }
+}
+
+// --- Helper Functions ---
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Returns ns per pixel
+static double bench(mono_flush_t fn, uint8_t * fb, const bench_area_t * a, const uint16_t * src,
+                    uint32_t flags, int iterations) {
+    uint64_t px = (uint64_t)(a->x2 - a->x1 + 1) * (a->y2 - a->y1 + 1);
+    fn(fb, a, src, flags);   // Warm up
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < iterations; i++) fn(fb, a, src, flags);
+    return (double)(now_ns() - t0) / iterations / px;
+}
+
+int main(int argc, char ** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) iterations = DEFAULT_ITERATIONS;
+
+    uint16_t * src = malloc(SCREEN_W * SCREEN_H * sizeof(uint16_t));
+    uint8_t * fb = malloc(LINE_LENGTH * SCREEN_H);
+    if (!src || !fb) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    // A horizontal gradient with some noise, like anti-aliased UI content
+    srand(1);
+    for (int y = 0; y < SCREEN_H; y++) {
+        for (int x = 0; x < SCREEN_W; x++) {
+            uint32_t v = (x * 31 / SCREEN_W + (rand() & 3)) & 31;
+            src[y * SCREEN_W + x] = (uint16_t)((v << 11) | (v << 6) | v);
+        }
+    }
+    memset(fb, 0, LINE_LENGTH * SCREEN_H);
+
+    static const bench_area_t areas[] = {
+        {"frame 320x240", 0, 0, SCREEN_W - 1, SCREEN_H - 1},
+        {"strip 301x24 @3", 3, 100, 303, 123},
+    };
+
+    printf("1 bpp, %d iterations (ns/pixel, Mpixel/s)\n", iterations);
+    printf("%-16s %18s %18s %18s\n", "area", "old loop", "threshold", "dither");
+    for (size_t i = 0; i < sizeof(areas) / sizeof(areas[0]); i++) {
+        const bench_area_t * a = &areas[i];
+        double old_ns = bench(old_loop, fb, a, src, 0, iterations);
+        double thr_ns = bench(packed_rows, fb, a, src, 0, iterations);
+        double dith_ns = bench(packed_rows, fb, a, src, FBDEV_MONO_DITHER, iterations);
+        printf("%-16s %8.3f %9.1f %8.3f %9.1f %8.3f %9.1f\n", a->name,
+               old_ns, 1e3 / old_ns, thr_ns, 1e3 / thr_ns, dith_ns, 1e3 / dith_ns);
+    }
+
+    free(src);
+    free(fb);
+    return 0;
+}
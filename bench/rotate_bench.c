@@ -0,0 +1,161 @@
+/**
+ * @file rotate_bench.c
+ * @brief Compares fbdev_rotate() with LVGL's sw_rotate loops on a 320x240 RGB565 frame.
+ *
+ * The frame is pushed in strips the way LVGL flushes it: each strip is rotated into a packed
+ * buffer and its rows are copied to their place in a screen-sized destination.
+ * The LVGL side is a copy of the loops in LVGL 8.3's lv_refr.c (draw_buf_rotate_90/180), whose
+ * strips are limited by LV_DISP_ROT_MAX_BUF; they are static there and cannot be called directly.
+ *
+ * Usage: rotate_bench [ITERATIONS]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "lv_drivers/display/fbdev_rotate.h"
+
+#define FRAME_W 320
+#define FRAME_H 240
+#define DEFAULT_ITERATIONS 200
+
+typedef void (*rotate_fn_t)(uint16_t * dst, uint16_t * src, uint32_t w, uint32_t h, fbdev_rotation_t rot);
+
+// --- LVGL 8.3 sw_rotate ---
+static void lvgl_rotate_90(bool invert_i, int32_t area_w, int32_t area_h, uint16_t * orig_color_p, uint16_t * rot_buf) {
+    uint32_t invert = (area_w * area_h) - 1;
+    uint32_t initial_i = ((area_w - 1) * area_h);
+    for (int32_t y = 0; y < area_h; y++) {
+        uint32_t i = initial_i + y;
+        if (invert_i) i = invert - i;
+        for (int32_t x = 0; x < area_w; x++) {
+            rot_buf[i] = *(orig_color_p++);
+            if (invert_i) i += area_h;
+            else i -= area_h;
+        }
+    }
+}
+
+// In place, like LVGL: the strip is reversed in the draw buffer
+static void lvgl_rotate_180(uint16_t * color_p, uint32_t total) {
+    uint32_t i = total - 1, j = 0;
+    while (i > j) {
+        uint16_t tmp = color_p[i];
+        color_p[i] = color_p[j];
+        color_p[j] = tmp;
+        i--;
+        j++;
+    }
+}
+
+// LVGL's 90 degree path (invert_i = false) turns the picture counter-clockwise
+static void lvgl_rotate(uint16_t * dst, uint16_t * src, uint32_t w, uint32_t h, fbdev_rotation_t rot) {
+    if (rot == FBDEV_ROT_180) {
+        lvgl_rotate_180(src, w * h);
+        memcpy(dst, src, w * h * sizeof(uint16_t));
+    } else {
+        lvgl_rotate_90(rot == FBDEV_ROT_90, w, h, src, dst);
+    }
+}
+
+static void fbdev_rotate_16(uint16_t * dst, uint16_t * src, uint32_t w, uint32_t h, fbdev_rotation_t rot) {
+    fbdev_rotate(dst, src, w, h, w, sizeof(uint16_t), rot);
+}
+
+// --- Helper Functions ---
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Rotate the frame strip by strip and place each rotated strip in the screen-oriented frame
+static void push_frame(rotate_fn_t fn, uint16_t * screen, uint16_t * frame, uint16_t * tmp,
+                       uint32_t strip_h, fbdev_rotation_t rot) {
+    bool swap = rot == FBDEV_ROT_90 || rot == FBDEV_ROT_270;
+    uint32_t screen_w = swap ? FRAME_H : FRAME_W;
+    for (uint32_t y1 = 0; y1 < FRAME_H; y1 += strip_h) {
+        uint32_t h = FRAME_H - y1 < strip_h ? FRAME_H - y1 : strip_h;
+        fn(tmp, frame + y1 * FRAME_W, FRAME_W, h, rot);
+
+        // Rotated strip: rw x rh at (rx, ry)
+        uint32_t rx, ry, rw, rh;
+        if (rot == FBDEV_ROT_90) {
+            rx = FRAME_H - y1 - h; ry = 0; rw = h; rh = FRAME_W;
+        } else if (rot == FBDEV_ROT_270) {
+            rx = y1; ry = 0; rw = h; rh = FRAME_W;
+        } else {
+            rx = 0; ry = FRAME_H - y1 - h; rw = FRAME_W; rh = h;
+        }
+        for (uint32_t r = 0; r < rh; r++) {
+            memcpy(screen + (ry + r) * screen_w + rx, tmp + r * rw, rw * sizeof(uint16_t));
+        }
+    }
+}
+
+static double bench(rotate_fn_t fn, uint16_t * screen, uint16_t * frame, uint16_t * tmp,
+                    uint32_t strip_h, fbdev_rotation_t rot, int iterations) {
+    push_frame(fn, screen, frame, tmp, strip_h, rot);   // Warm up
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < iterations; i++) push_frame(fn, screen, frame, tmp, strip_h, rot);
+    return (double)(now_ns() - t0) / iterations;
+}
+
+int main(int argc, char ** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) iterations = DEFAULT_ITERATIONS;
+
+    size_t frame_bytes = FRAME_W * FRAME_H * sizeof(uint16_t);
+    uint16_t * frame = malloc(frame_bytes);
+    uint16_t * frame_copy = malloc(frame_bytes);
+    uint16_t * tmp = malloc(frame_bytes);
+    uint16_t * ref = malloc(frame_bytes);
+    uint16_t * out = malloc(frame_bytes);
+    if (!frame || !frame_copy || !tmp || !ref || !out) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    srand(1);
+    for (uint32_t i = 0; i < FRAME_W * FRAME_H; i++) frame[i] = (uint16_t)rand();
+
+    // LVGL splits a strip so that the rotated copy fits into LV_DISP_ROT_MAX_BUF (10 KiB here)
+    static const uint32_t strip_heights[] = {16, 24, FRAME_H};
+    static const fbdev_rotation_t rots[] = {FBDEV_ROT_90, FBDEV_ROT_180, FBDEV_ROT_270};
+    static const char * const rot_names[] = {"0", "90", "180", "270"};
+    int failed = 0;
+
+    printf("%dx%d RGB565, %d iterations, tile %d\n", FRAME_W, FRAME_H, iterations, FBDEV_ROTATE_TILE);
+    printf("%-5s %-6s %12s %12s %8s\n", "angle", "strip", "lvgl ms", "fbdev ms", "speedup");
+    for (size_t r = 0; r < sizeof(rots) / sizeof(rots[0]); r++) {
+        for (size_t s = 0; s < sizeof(strip_heights) / sizeof(strip_heights[0]); s++) {
+            fbdev_rotation_t rot = rots[r];
+            uint32_t strip_h = strip_heights[s];
+
+            // Both must produce the same screen (the LVGL 180 path works in place: use a copy)
+            memcpy(frame_copy, frame, frame_bytes);
+            push_frame(lvgl_rotate, ref, frame_copy, tmp, strip_h, rot);
+            push_frame(fbdev_rotate_16, out, frame, tmp, strip_h, rot);
+            if (memcmp(ref, out, frame_bytes) != 0) {
+                fprintf(stderr, "Mismatch at %s degrees, %u line strips\n", rot_names[rot], strip_h);
+                failed++;
+            }
+
+            double lvgl_ns = bench(lvgl_rotate, out, frame_copy, tmp, strip_h, rot, iterations);
+            double fbdev_ns = bench(fbdev_rotate_16, out, frame, tmp, strip_h, rot, iterations);
+            printf("%-5s %-6u %12.3f %12.3f %7.2fx\n", rot_names[rot], strip_h, lvgl_ns / 1e6, fbdev_ns / 1e6,
+                   lvgl_ns / fbdev_ns);
+        }
+    }
+
+    free(frame);
+    free(frame_copy);
+    free(tmp);
+    free(ref);
+    free(out);
+    return failed ? 1 : 0;
+}
@@ -6,17 +6,28 @@
 /*********************
  *      INCLUDES
  *********************/
+#define _DEFAULT_SOURCE /*ftruncate()*/
 #include "fbdev.h"
 #if USE_FBDEV || USE_BSD_FBDEV
 
+#include "fbdev_pixconv.h"
+#include "fbdev_copy.h"
 #include <stdlib.h>
 #include <unistd.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/ioctl.h>
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #if USE_BSD_FBDEV
 #include <sys/fcntl.h>
 #include <sys/time.h>
@@ -33,6 +44,55 @@
 #define FBDEV_PATH  "/dev/fb0"
 #endif
 
+#if USE_BSD_FBDEV
+#undef FBDEV_PAGE_FLIP
+#define FBDEV_PAGE_FLIP 0
+#endif
+
+#ifndef FBDEV_PAGE_FLIP
+#define FBDEV_PAGE_FLIP 0
+#endif
+
+#ifndef FBDEV_WAIT_VSYNC
+#define FBDEV_WAIT_VSYNC 0
+#endif
+
+/*Areas remembered per frame to keep the two pages in sync; more than this syncs the whole screen*/
+#define FBDEV_DIRTY_MAX 32
+
+#ifndef FBDEV_SHADOW
+#define FBDEV_SHADOW 0
+#endif
+
+#ifndef FBDEV_ROTATION
+#define FBDEV_ROTATION 0
+#endif
+
+#if USE_BSD_FBDEV
+#undef FBDEV_NEGOTIATE
+#define FBDEV_NEGOTIATE 0
+#endif
+
+#ifndef FBDEV_NEGOTIATE
+#define FBDEV_NEGOTIATE 0
+#endif
+
+/*1 bpp panels: ordered dithering (else a 50% threshold), leftmost pixel in the MSB (else the LSB)*/
+#ifndef FBDEV_1BPP_DITHER
+#define FBDEV_1BPP_DITHER 1
+#endif
+
+#ifndef FBDEV_1BPP_MSB_FIRST
+#define FBDEV_1BPP_MSB_FIRST 0
+#endif
+
+#ifndef FBDEV_SCALE_MAX
+#define FBDEV_SCALE_MAX 3
+#endif
+
+/*Unchanged 16 byte blocks tolerated inside one written span of the shadow diff*/
+#define FBDEV_SHADOW_GAP_BLOCKS 2
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -57,6 +117,25 @@ struct bsd_fb_fix_info{
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static bool format_matches_lv_color(void);
+static bool device_open(void);
+static bool file_open(void);
+static void pixconv_init(void);
+static void shadow_init(void);
+static void shadow_free(void);
+static void clear_borders(uint32_t yoffset);
+static bool rot_buf_reserve(uint32_t px);
+static void shadow_write_row(uint8_t * dst, uint8_t * shadow_row, const uint16_t * src, uint32_t w);
+#if !USE_BSD_FBDEV
+static void mode_negotiate(void);
+static bool mode_try(bool depth, bool pages);
+#endif
+#if FBDEV_PAGE_FLIP
+static void page_flip_init(void);
+static void page_flip_present(void);
+static void dirty_add(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+static void copy_area(uint32_t dst_yoffset, uint32_t src_yoffset, const lv_area_t * area);
+#endif
 
 /**********************
  *  STATIC VARIABLES
@@ -71,6 +150,50 @@ static struct fb_fix_screeninfo finfo;
 static char *fbp = 0;
 static long int screensize = 0;
 static int fbfd = 0;
+static fbdev_stats_t stats;
+static bool direct_mode;            /*LVGL renders straight into the mapped framebuffer*/
+static fbdev_pixconv_fn_t pixconv;  /*Row converter for 16 bit LVGL colours, NULL: use the generic branches*/
+static uint32_t pixconv_bytes;      /*Bytes per framebuffer pixel written by pixconv*/
+static fbdev_pixfmt_t pixfmt = FBDEV_PIXFMT_CNT;
+static uint32_t mono_flags;         /*fbdev_pixconv_mono_row() flags for 1 bpp screens*/
+
+static bool use_file;               /*Map file.path with synthetic screen info instead of FBDEV_PATH*/
+static fbdev_file_t file;
+
+static bool negotiate = FBDEV_NEGOTIATE;
+#if !USE_BSD_FBDEV
+static struct fb_var_screeninfo orig_vinfo;  /*Mode found at fbdev_init(), restored by fbdev_exit()*/
+static bool mode_changed;
+#endif
+
+static fbdev_rotation_t rotation = FBDEV_ROTATION / 90;
+static lv_color_t * rot_buf;        /*The flushed area turned into the panel's orientation*/
+static uint32_t rot_buf_px;
+
+static uint32_t scale = 1;          /*Integer upscale from LVGL's logical resolution to the screen*/
+static uint32_t scale_hor_res;      /*Logical resolution in the panel's orientation*/
+static uint32_t scale_ver_res;
+static uint32_t scale_x0;           /*Top left corner of the scaled picture (centred, letterboxed)*/
+static uint32_t scale_y0;
+static uint16_t * scale_row;        /*One upscaled RGB565 row*/
+static uint8_t * scale_out;         /*The same row in the framebuffer's format*/
+
+static bool shadow_enabled = FBDEV_SHADOW;
+static uint8_t * shadow;            /*RAM copy of the visible screen (packed rows), NULL if not used*/
+static uint32_t shadow_stride;
+static uint8_t * shadow_scratch;    /*One converted row before diffing*/
+static bool shadow_pending;         /*Set up by fbdev_prepare(), once direct mode and scaling are decided*/
+static uint64_t frame_copy_bytes;
+static uint64_t frame_write_bytes;
+
+#if FBDEV_PAGE_FLIP
+static bool page_flip;              /*Frames are rendered into the back page and panned to*/
+static uint32_t back_yoffset;       /*First line of the back page; vinfo.yoffset is the front page*/
+static bool vsync_ok = true;        /*Cleared once FBIO_WAITFORVSYNC fails*/
+static lv_area_t dirty[FBDEV_DIRTY_MAX];
+static uint32_t dirty_cnt;
+static bool dirty_full;             /*Sync the whole page after the next flip*/
+#endif
 
 /**********************
  *      MACROS
@@ -85,12 +208,43 @@ static int fbfd = 0;
  **********************/
 
 void fbdev_init(void)
+{
+    shadow_free();
+    if(use_file ? !file_open() : !device_open()) return;
+
+    LV_LOG_INFO("%dx%d, %dbpp", vinfo.xres, vinfo.yres, vinfo.bits_per_pixel);
+
+    pixconv_init();
+
+    // Figure out the size of the screen in bytes
+    screensize =  finfo.smem_len; //finfo.line_length * vinfo.yres;    
+
+    // Map the device to memory
+    fbp = (char *)mmap(0, screensize, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
+    if((intptr_t)fbp == -1) {
+        perror("Error: failed to map framebuffer device to memory");
+        fbp = NULL;
+        return;
+    }
+
+    // Don't initialise the memory to retain what's currently displayed / avoid clearing the screen.
+    // This is important for applications that only draw to a subsection of the full framebuffer.
+
+    LV_LOG_INFO("The framebuffer device was mapped to memory successfully");
+
+#if FBDEV_PAGE_FLIP
+    page_flip_init();
+#endif
+    shadow_pending = shadow_enabled;
+}
+
+static bool device_open(void)
 {
     // Open the file for reading and writing
     fbfd = open(FBDEV_PATH, O_RDWR);
     if(fbfd == -1) {
         perror("Error: cannot open framebuffer device");
-        return;
+        return false;
     }
     LV_LOG_INFO("The framebuffer device was opened successfully");
 
@@ -107,13 +261,13 @@ void fbdev_init(void)
     //Get fb type
     if (ioctl(fbfd, FBIOGTYPE, &fb) != 0) {
         perror("ioctl(FBIOGTYPE)");
-        return;
+        return false;
     }
 
     //Get screen width
     if (ioctl(fbfd, FBIO_GETLINEWIDTH, &line_length) != 0) {
         perror("ioctl(FBIO_GETLINEWIDTH)");
-        return;
+        return false;
     }
 
     vinfo.xres = (unsigned) fb.fb_width;
@@ -128,38 +282,108 @@ void fbdev_init(void)
     // Get fixed screen information
     if(ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo) == -1) {
         perror("Error reading fixed information");
-        return;
+        return false;
     }
 
     // Get variable screen information
     if(ioctl(fbfd, FBIOGET_VSCREENINFO, &vinfo) == -1) {
         perror("Error reading variable information");
-        return;
+        return false;
     }
-#endif /* USE_BSD_FBDEV */
 
-    LV_LOG_INFO("%dx%d, %dbpp", vinfo.xres, vinfo.yres, vinfo.bits_per_pixel);
-
-    // Figure out the size of the screen in bytes
-    screensize =  finfo.smem_len; //finfo.line_length * vinfo.yres;    
+    if(negotiate) mode_negotiate();
+#endif /* USE_BSD_FBDEV */
+    return true;
+}
 
-    // Map the device to memory
-    fbp = (char *)mmap(0, screensize, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
-    if((intptr_t)fbp == -1) {
-        perror("Error: failed to map framebuffer device to memory");
-        return;
+/*A regular file stands in for the device: no ioctls, the screen info comes from fbdev_set_file()*/
+static bool file_open(void)
+{
+    fbfd = open(file.path, O_RDWR | O_CREAT, 0644);
+    if(fbfd == -1) {
+        perror(file.path);
+        return false;
     }
 
-    // Don't initialise the memory to retain what's currently displayed / avoid clearing the screen.
-    // This is important for applications that only draw to a subsection of the full framebuffer.
-
-    LV_LOG_INFO("The framebuffer device was mapped to memory successfully");
+    memset(&vinfo, 0, sizeof(vinfo));
+    memset(&finfo, 0, sizeof(finfo));
+    vinfo.xres = file.xres;
+    vinfo.yres = file.yres;
+    vinfo.xoffset = file.xoffset;
+    vinfo.yoffset = file.yoffset;
+    vinfo.bits_per_pixel = file.bits_per_pixel;
+    finfo.line_length = file.line_length;
+    finfo.smem_len = file.line_length * (file.yres + file.yoffset);
+#if !USE_BSD_FBDEV
+    vinfo.xres_virtual = file.xres + file.xoffset;
+    vinfo.yres_virtual = file.yres + file.yoffset;
+    finfo.type = FB_TYPE_PACKED_PIXELS;
+    if(file.bits_per_pixel == 1) finfo.visual = FB_VISUAL_MONO10;
+    else if(file.bits_per_pixel == 8) finfo.visual = FB_VISUAL_PSEUDOCOLOR;
+    else finfo.visual = FB_VISUAL_TRUECOLOR;
+    if(file.bits_per_pixel == 16) {
+        vinfo.red.length = 5;
+        vinfo.green.length = 6;
+        vinfo.blue.length = 5;
+        vinfo.red.offset = 11;
+        vinfo.green.offset = 5;
+    }
+    else if(file.bits_per_pixel >= 24) {
+        vinfo.red.length = 8;
+        vinfo.green.length = 8;
+        vinfo.blue.length = 8;
+        vinfo.red.offset = 16;
+        vinfo.green.offset = 8;
+    }
+    if(file.bgr) {
+        vinfo.blue.offset = vinfo.red.offset;
+        vinfo.red.offset = 0;
+    }
+#endif
 
+    /*Grow the file to the whole virtual screen; mapping past its end would fault*/
+    struct stat st;
+    if(fstat(fbfd, &st) != 0 || (st.st_size < (off_t)finfo.smem_len && ftruncate(fbfd, finfo.smem_len) != 0)) {
+        perror(file.path);
+        close(fbfd);
+        fbfd = 0;
+        return false;
+    }
+    LV_LOG_INFO("Using %s as the framebuffer", file.path);
+    return true;
 }
 
 void fbdev_exit(void)
 {
+    if(fbfd <= 0) return;
+#if !USE_BSD_FBDEV
+    /*Leave the screen in the mode other programs found it in*/
+    if(mode_changed && ioctl(fbfd, FBIOPUT_VSCREENINFO, &orig_vinfo) != 0) {
+        perror("ioctl(FBIOPUT_VSCREENINFO)");
+    }
+    mode_changed = false;
+#endif
+    if(fbp) munmap(fbp, screensize);
+    fbp = NULL;
     close(fbfd);
+    fbfd = 0;
+}
+
+bool fbdev_mode_changed(void)
+{
+#if USE_BSD_FBDEV
+    return false;
+#else
+    return mode_changed;
+#endif
+}
+
+void fbdev_restore_mode(void)
+{
+#if !USE_BSD_FBDEV
+    /*Only the ioctl: this runs in signal handlers, possibly while a flush is writing to fbp*/
+    if(fbfd > 0 && mode_changed) ioctl(fbfd, FBIOPUT_VSCREENINFO, &orig_vinfo);
+#endif
 }
 
 /**
@@ -170,11 +394,19 @@ void fbdev_exit(void)
  */
 void fbdev_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p)
 {
+    /*Areas are in LVGL's coordinates: logical pixels when upscaling, exchanged axes at 90/270 degrees*/
+    int32_t max_x = (scale > 1 ? (int32_t)scale_hor_res : (int32_t)vinfo.xres) - 1;
+    int32_t max_y = (scale > 1 ? (int32_t)scale_ver_res : (int32_t)vinfo.yres) - 1;
+    if(rotation == FBDEV_ROT_90 || rotation == FBDEV_ROT_270) {
+        int32_t tmp = max_x;
+        max_x = max_y;
+        max_y = tmp;
+    }
     if(fbp == NULL ||
             area->x2 < 0 ||
             area->y2 < 0 ||
-            area->x1 > (int32_t)vinfo.xres - 1 ||
-            area->y1 > (int32_t)vinfo.yres - 1) {
+            area->x1 > max_x ||
+            area->y1 > max_y) {
         lv_disp_flush_ready(drv);
         return;
     }
@@ -182,53 +414,173 @@ void fbdev_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color
     /*Truncate the area to the screen*/
     int32_t act_x1 = area->x1 < 0 ? 0 : area->x1;
     int32_t act_y1 = area->y1 < 0 ? 0 : area->y1;
-    int32_t act_x2 = area->x2 > (int32_t)vinfo.xres - 1 ? (int32_t)vinfo.xres - 1 : area->x2;
-    int32_t act_y2 = area->y2 > (int32_t)vinfo.yres - 1 ? (int32_t)vinfo.yres - 1 : area->y2;
+    int32_t act_x2 = area->x2 > max_x ? max_x : area->x2;
+    int32_t act_y2 = area->y2 > max_y ? max_y : area->y2;
+
+    /*Turn the visible part into the panel's orientation; from here on everything is in screen space*/
+    lv_area_t rot_area;
+    if(rotation != FBDEV_ROT_0) {
+        uint32_t aw = act_x2 - act_x1 + 1;
+        uint32_t ah = act_y2 - act_y1 + 1;
+        if(!rot_buf_reserve(aw * ah)) {
+            stats.dropped++;
+            lv_disp_flush_ready(drv);
+            return;
+        }
+        lv_coord_t src_w = lv_area_get_width(area);
+        fbdev_rotate(rot_buf, color_p + (act_y1 - area->y1) * src_w + (act_x1 - area->x1), aw, ah, src_w,
+                     sizeof(lv_color_t), rotation);
 
+        /*max_x / max_y are the last LVGL column and row*/
+        if(rotation == FBDEV_ROT_90) {
+            lv_area_set(&rot_area, max_y - act_y2, act_x1, max_y - act_y1, act_x2);
+        }
+        else if(rotation == FBDEV_ROT_180) {
+            lv_area_set(&rot_area, max_x - act_x2, max_y - act_y2, max_x - act_x1, max_y - act_y1);
+        }
+        else {
+            lv_area_set(&rot_area, act_y1, max_x - act_x2, act_y2, max_x - act_x1);
+        }
+        act_x1 = rot_area.x1;
+        act_y1 = rot_area.y1;
+        act_x2 = rot_area.x2;
+        act_y2 = rot_area.y2;
+        area = &rot_area;
+        color_p = rot_buf;
+    }
 
     lv_coord_t w = (act_x2 - act_x1 + 1);
+    uint32_t yoffset = vinfo.yoffset;
+
+    stats.flushes++;
+
+#if FBDEV_PAGE_FLIP
+    /*Draw into the hidden page; it is shown when the last area of the frame arrives*/
+    if(page_flip) {
+        /*In direct mode LVGL alternates between the pages itself: follow its buffer*/
+        if(direct_mode) back_yoffset = ((char *)color_p - fbp) / finfo.line_length;
+        yoffset = back_yoffset;
+        if(scale > 1) {
+            dirty_add(scale_x0 + act_x1 * scale, scale_y0 + act_y1 * scale,
+                      scale_x0 + (act_x2 + 1) * scale - 1, scale_y0 + (act_y2 + 1) * scale - 1);
+        }
+        else {
+            dirty_add(act_x1, act_y1, act_x2, act_y2);
+        }
+    }
+#endif
     long int location = 0;
-    long int byte_location = 0;
-    unsigned char bit_location = 0;
 
-    /*32 or 24 bit per pixel*/
-    if(vinfo.bits_per_pixel == 32 || vinfo.bits_per_pixel == 24) {
-        uint32_t * fbp32 = (uint32_t *)fbp;
+    if(!direct_mode) {
+        uint64_t bytes = ((uint64_t)w * scale * vinfo.bits_per_pixel + 7) / 8 * (act_y2 - act_y1 + 1) * scale;
+        stats.copy_bytes += bytes;
+        frame_copy_bytes += bytes;
+        /*The shadow diff counts what it actually writes*/
+        if(!shadow) {
+            stats.write_bytes += bytes;
+            frame_write_bytes += bytes;
+        }
+    }
+
+    if(direct_mode) {
+        /*Already drawn in place, nothing to copy*/
+    }
+    /*Integer upscaling: every logical pixel becomes a scale x scale block*/
+    else if(scale > 1) {
+        lv_coord_t src_w = lv_area_get_width(area);
+        const uint16_t * src = (const uint16_t *)color_p + (act_y1 - area->y1) * src_w + (act_x1 - area->x1);
+        uint32_t out_w = w * scale;
+        uint32_t out_bytes = out_w * pixconv_bytes;
+        uint8_t * dst = (uint8_t *)fbp + (scale_y0 + act_y1 * scale + yoffset) * finfo.line_length +
+                        (scale_x0 + act_x1 * scale + vinfo.xoffset) * pixconv_bytes;
+        /*Build the row once in RAM and store it `scale` times: the framebuffer is never read back*/
+        const uint8_t * out = pixfmt == FBDEV_PIXFMT_RGB565 ? (const uint8_t *)scale_row : scale_out;
         int32_t y;
+        uint32_t k;
         for(y = act_y1; y <= act_y2; y++) {
-            location = (act_x1 + vinfo.xoffset) + (y + vinfo.yoffset) * finfo.line_length / 4;
-            memcpy(&fbp32[location], (uint32_t *)color_p, (act_x2 - act_x1 + 1) * 4);
-            color_p += w;
+            fbdev_pixconv_upscale_row(scale_row, src, w, scale);
+            if(out == scale_out) pixconv(scale_out, scale_row, out_w);
+            for(k = 0; k < scale; k++) {
+                fbdev_copy(dst, out, out_bytes);
+                dst += finfo.line_length;
+            }
+            src += src_w;
         }
     }
-    /*16 bit per pixel*/
-    else if(vinfo.bits_per_pixel == 16) {
-        uint16_t * fbp16 = (uint16_t *)fbp;
+    /*16 bit colours converted (or copied) to the framebuffer's format*/
+    else if(pixconv) {
+        lv_coord_t src_w = lv_area_get_width(area);
+        const uint16_t * src = (const uint16_t *)color_p + (act_y1 - area->y1) * src_w + (act_x1 - area->x1);
+        uint8_t * dst = (uint8_t *)fbp + (act_y1 + yoffset) * finfo.line_length + (act_x1 + vinfo.xoffset) * pixconv_bytes;
+        int32_t y;
+        if(shadow) {
+            uint8_t * shadow_row = shadow + act_y1 * shadow_stride + act_x1 * pixconv_bytes;
+            for(y = act_y1; y <= act_y2; y++) {
+                shadow_write_row(dst, shadow_row, src, w);
+                dst += finfo.line_length;
+                shadow_row += shadow_stride;
+                src += src_w;
+            }
+        }
+        else if(pixfmt == FBDEV_PIXFMT_RGB565) {
+            for(y = act_y1; y <= act_y2; y++) {
+                fbdev_copy(dst, src, w * 2);
+                dst += finfo.line_length;
+                src += src_w;
+            }
+        }
+        else {
+            for(y = act_y1; y <= act_y2; y++) {
+                pixconv(dst, src, w);
+                dst += finfo.line_length;
+                src += src_w;
+            }
+        }
+    }
+    /*32 bit per pixel*/
+    else if(vinfo.bits_per_pixel == 32 && LV_COLOR_DEPTH == 32) {
+        uint32_t * fbp32 = (uint32_t *)fbp;
         int32_t y;
         for(y = act_y1; y <= act_y2; y++) {
-            location = (act_x1 + vinfo.xoffset) + (y + vinfo.yoffset) * finfo.line_length / 2;
-            memcpy(&fbp16[location], (uint32_t *)color_p, (act_x2 - act_x1 + 1) * 2);
+            location = (act_x1 + vinfo.xoffset) + (y + yoffset) * finfo.line_length / 4;
+            fbdev_copy(&fbp32[location], (uint32_t *)color_p, (act_x2 - act_x1 + 1) * 4);
             color_p += w;
         }
     }
-    /*8 bit per pixel*/
-    else if(vinfo.bits_per_pixel == 8) {
-        uint8_t * fbp8 = (uint8_t *)fbp;
+    /*8 bit per pixel: only LVGL's own 8 bit colours are copied, there is no RGB565 -> palette converter*/
+    else if(vinfo.bits_per_pixel == 8 && LV_COLOR_DEPTH == 8) {
+        lv_coord_t src_w = lv_area_get_width(area);
+        const uint8_t * src = (const uint8_t *)color_p + (act_y1 - area->y1) * src_w + (act_x1 - area->x1);
+        uint8_t * dst = (uint8_t *)fbp + (act_y1 + yoffset) * finfo.line_length + act_x1 + vinfo.xoffset;
         int32_t y;
         for(y = act_y1; y <= act_y2; y++) {
-            location = (act_x1 + vinfo.xoffset) + (y + vinfo.yoffset) * finfo.line_length;
-            memcpy(&fbp8[location], (uint32_t *)color_p, (act_x2 - act_x1 + 1));
-            color_p += w;
+            fbdev_copy(dst, src, w);
+            dst += finfo.line_length;
+            src += src_w;
         }
     }
     /*1 bit per pixel*/
     else if(vinfo.bits_per_pixel == 1) {
+#if LV_COLOR_DEPTH == 16
+        /*Packed by luminance 8 pixels at a time; only partial bytes at the row ends are read*/
+        lv_coord_t src_w = lv_area_get_width(area);
+        const uint16_t * src = (const uint16_t *)color_p + (act_y1 - area->y1) * src_w + (act_x1 - area->x1);
+        uint8_t * row = (uint8_t *)fbp + (act_y1 + yoffset) * finfo.line_length;
+        int32_t y;
+        for(y = act_y1; y <= act_y2; y++) {
+            fbdev_pixconv_mono_row(row, src, act_x1 + vinfo.xoffset, w, y, mono_flags);
+            row += finfo.line_length;
+            src += src_w;
+        }
+#else
+        long int byte_location = 0;
+        unsigned char bit_location = 0;
         uint8_t * fbp8 = (uint8_t *)fbp;
         int32_t x;
         int32_t y;
         for(y = act_y1; y <= act_y2; y++) {
             for(x = act_x1; x <= act_x2; x++) {
-                location = (x + vinfo.xoffset) + (y + vinfo.yoffset) * vinfo.xres;
+                location = (x + vinfo.xoffset) + (y + yoffset) * finfo.line_length * 8;
                 byte_location = location / 8; /* find the byte we need to change */
                 bit_location = location % 8; /* inside the byte found, find the bit we need to change */
                 fbp8[byte_location] &= ~(((uint8_t)(1)) << bit_location);
@@ -238,6 +590,7 @@ void fbdev_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color
 
             color_p += area->x2 - act_x2;
         }
+#endif
     } else {
         /*Not supported bit per pixel*/
     }
@@ -245,6 +598,17 @@ void fbdev_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color
     //May be some direct update command is required
     //ret = ioctl(state->fd, FBIO_UPDATE, (unsigned long)((uintptr_t)rect));
 
+    if(lv_disp_flush_is_last(drv)) {
+        stats.frames++;
+        stats.last_frame_copy_bytes = frame_copy_bytes;
+        stats.last_frame_write_bytes = frame_write_bytes;
+        frame_copy_bytes = 0;
+        frame_write_bytes = 0;
+#if FBDEV_PAGE_FLIP
+        if(page_flip) page_flip_present();
+#endif
+    }
+
     lv_disp_flush_ready(drv);
 }
 
@@ -256,13 +620,608 @@ void fbdev_get_sizes(uint32_t *width, uint32_t *height) {
         *height = vinfo.yres;
 }
 
+bool fbdev_blank(bool blank) {
+    if(fbfd <= 0 || use_file) return false;
+
+#if USE_BSD_FBDEV
+    int mode = blank ? V_DISPLAY_BLANK : V_DISPLAY_ON;
+#else
+    int mode = blank ? FB_BLANK_POWERDOWN : FB_BLANK_UNBLANK;
+#endif
+    if(ioctl(fbfd, FBIOBLANK, mode) != 0) {
+        perror("ioctl(FBIOBLANK)");
+        return false;
+    }
+    return true;
+}
+
+uint32_t fbdev_get_screen_bytes(void) {
+    if(fbp == NULL) return 0;
+    return ((vinfo.xres * vinfo.bits_per_pixel + 7) / 8) * vinfo.yres;
+}
+
+uint32_t fbdev_get_bpp(void) {
+    return vinfo.bits_per_pixel;
+}
+
+bool fbdev_read_screen(void * buf) {
+    if(fbp == NULL) return false;
+
+    uint32_t row = (vinfo.xres * vinfo.bits_per_pixel + 7) / 8;
+    uint32_t x_ofs = (vinfo.xoffset * vinfo.bits_per_pixel) / 8;
+    uint8_t * dst = buf;
+    uint32_t y;
+    for(y = 0; y < vinfo.yres; y++) {
+        memcpy(dst, fbp + (y + vinfo.yoffset) * finfo.line_length + x_ofs, row);
+        dst += row;
+    }
+    return true;
+}
+
+bool fbdev_write_screen(const void * buf) {
+    if(fbp == NULL) return false;
+
+    uint32_t row = (vinfo.xres * vinfo.bits_per_pixel + 7) / 8;
+    uint32_t x_ofs = (vinfo.xoffset * vinfo.bits_per_pixel) / 8;
+    const uint8_t * src = buf;
+    uint32_t y;
+    for(y = 0; y < vinfo.yres; y++) {
+        fbdev_copy(fbp + (y + vinfo.yoffset) * finfo.line_length + x_ofs, src, row);
+        src += row;
+    }
+    if(shadow) memcpy(shadow, buf, row * vinfo.yres);
+    return true;
+}
+
 void fbdev_set_offset(uint32_t xoffset, uint32_t yoffset) {
     vinfo.xoffset = xoffset;
     vinfo.yoffset = yoffset;
 }
 
+bool fbdev_direct_init(lv_coord_t hor_res, lv_coord_t ver_res, void ** buf1, void ** buf2) {
+    *buf1 = NULL;
+    *buf2 = NULL;
+    if(fbp == NULL) return false;
+
+    /*LVGL would write the framebuffer itself, leaving nothing for the shadow to diff*/
+    if(shadow_enabled) {
+        LV_LOG_INFO("Direct mode not used with the shadow framebuffer, using the copy path");
+        return false;
+    }
+
+    /*LVGL's buffer must have exactly the screen's layout: same pixel format, no row padding*/
+    if(!format_matches_lv_color() || rotation != FBDEV_ROT_0 ||
+       vinfo.xres != (uint32_t)hor_res || vinfo.yres != (uint32_t)ver_res || vinfo.xoffset != 0 ||
+       finfo.line_length != vinfo.xres * sizeof(lv_color_t)) {
+        LV_LOG_INFO("Direct mode not possible (%dbpp, line length %d), using the copy path",
+                    vinfo.bits_per_pixel, finfo.line_length);
+        return false;
+    }
+
+    char * front = fbp + vinfo.yoffset * finfo.line_length;
+#if FBDEV_PAGE_FLIP
+    if(page_flip) {
+        *buf1 = fbp + back_yoffset * finfo.line_length;  /*LVGL starts with buf1*/
+        *buf2 = front;
+    }
+    else
+#endif
+    {
+        *buf1 = front;
+    }
+
+    direct_mode = true;
+    LV_LOG_INFO("Direct mode: LVGL renders into the framebuffer (%s)", *buf2 ? "2 pages" : "1 page");
+    return true;
+}
+
+void fbdev_set_rotation(fbdev_rotation_t rot) {
+    rotation = rot;
+}
+
+fbdev_rotation_t fbdev_get_rotation(void) {
+    return rotation;
+}
+
+uint32_t fbdev_set_scale(lv_coord_t hor_res, lv_coord_t ver_res, uint32_t factor) {
+    scale = 1;
+    if(fbp == NULL || pixconv == NULL || hor_res <= 0 || ver_res <= 0 || factor == 1) return 1;
+    if(rotation == FBDEV_ROT_90 || rotation == FBDEV_ROT_270) {
+        lv_coord_t tmp = hor_res;
+        hor_res = ver_res;
+        ver_res = tmp;
+    }
+
+    uint32_t fit_x = vinfo.xres / hor_res;
+    uint32_t fit_y = vinfo.yres / ver_res;
+    uint32_t fit = fit_x < fit_y ? fit_x : fit_y;
+    if(factor == 0) factor = fit < FBDEV_SCALE_MAX ? fit : FBDEV_SCALE_MAX;
+    if(factor < 2 || factor > fit) return 1;
+
+    free(scale_row);
+    free(scale_out);
+    scale_row = malloc(hor_res * factor * sizeof(uint16_t));
+    scale_out = malloc(hor_res * factor * pixconv_bytes);
+    if(scale_row == NULL || scale_out == NULL) {
+        free(scale_row);
+        free(scale_out);
+        scale_row = NULL;
+        scale_out = NULL;
+        return 1;
+    }
+
+    scale = factor;
+    scale_hor_res = hor_res;
+    scale_ver_res = ver_res;
+    scale_x0 = (vinfo.xres - hor_res * factor) / 2;
+    scale_y0 = (vinfo.yres - ver_res * factor) / 2;
+
+    /*The shadow diff works on unscaled rows*/
+    if(shadow_pending || shadow) LV_LOG_WARN("Shadow framebuffer not used with upscaling");
+    shadow_pending = false;
+    shadow_free();
+
+    clear_borders(vinfo.yoffset);
+#if FBDEV_PAGE_FLIP
+    if(page_flip) clear_borders(back_yoffset);
+#endif
+    LV_LOG_INFO("Upscaling %dx%d by %d at %d,%d", hor_res, ver_res, factor, scale_x0, scale_y0);
+    return scale;
+}
+
+void fbdev_prepare(uint32_t max_area_px) {
+    if(shadow_pending) shadow_init();
+    if(rotation != FBDEV_ROT_0 && !rot_buf_reserve(max_area_px)) {
+        LV_LOG_ERROR("No memory for the rotation buffer (%d pixels)", max_area_px);
+    }
+}
+
+const char * fbdev_get_pipeline(void) {
+    static char name[64];
+    if(fbp == NULL) return "none";
+    if(direct_mode) return "direct";
+    if(pixconv && pixfmt == FBDEV_PIXFMT_RGB565) {
+        snprintf(name, sizeof(name), "RGB565 copy (%s)", FBDEV_COPY_STREAM ? fbdev_copy_impl_name() : "memcpy");
+    }
+    else if(pixconv) {
+        snprintf(name, sizeof(name), "RGB565 -> %s (%s)", fbdev_pixfmt_name(pixfmt),
+                 fbdev_pixconv_impl_name(fbdev_pixconv_best(pixfmt)));
+    }
+    else if(vinfo.bits_per_pixel == 1 && LV_COLOR_DEPTH == 16) {
+        snprintf(name, sizeof(name), "1 bpp %s", (mono_flags & FBDEV_MONO_DITHER) ? "dithered" : "threshold");
+    }
+    else if(vinfo.bits_per_pixel != 1 && vinfo.bits_per_pixel != LV_COLOR_DEPTH) {
+        return "unsupported";
+    }
+    else {
+        snprintf(name, sizeof(name), "%d bit -> %dbpp copy (%s)", LV_COLOR_DEPTH, vinfo.bits_per_pixel,
+                 FBDEV_COPY_STREAM ? fbdev_copy_impl_name() : "memcpy");
+    }
+    return name;
+}
+
+void fbdev_set_file(const fbdev_file_t * f) {
+    use_file = f != NULL;
+    if(f) file = *f;
+}
+
+bool fbdev_file_parse(const char * spec, fbdev_file_t * f) {
+    memset(f, 0, sizeof(*f));
+    const char * comma = strchr(spec, ',');
+    if(comma == NULL || comma == spec || (size_t)(comma - spec) >= sizeof(f->path)) return false;
+    memcpy(f->path, spec, comma - spec);
+
+    char * end;
+    f->xres = strtoul(comma + 1, &end, 10);
+    if(*end != 'x') return false;
+    f->yres = strtoul(end + 1, &end, 10);
+    if(*end != ',') return false;
+    f->bits_per_pixel = strtoul(end + 1, &end, 10);
+    while(*end == ',') {
+        const char * opt = end + 1;
+        if(strncmp(opt, "stride=", 7) == 0) f->line_length = strtoul(opt + 7, &end, 10);
+        else if(strncmp(opt, "xoffset=", 8) == 0) f->xoffset = strtoul(opt + 8, &end, 10);
+        else if(strncmp(opt, "yoffset=", 8) == 0) f->yoffset = strtoul(opt + 8, &end, 10);
+        else if(strncmp(opt, "bgr", 3) == 0) {
+            f->bgr = true;
+            end = (char *)opt + 3;
+        }
+        else return false;
+    }
+    if(*end != '\0' || f->xres == 0 || f->yres == 0) return false;
+    switch(f->bits_per_pixel) {
+        case 1:
+        case 8:
+        case 16:
+        case 24:
+        case 32:
+            break;
+        default:
+            return false;
+    }
+
+    uint32_t packed = ((f->xres + f->xoffset) * f->bits_per_pixel + 7) / 8;
+    if(f->line_length == 0) f->line_length = packed;
+    return f->line_length >= packed;
+}
+
+void fbdev_set_negotiate(bool enable) {
+    negotiate = enable;
+}
+
+void fbdev_set_shadow(bool enable) {
+    shadow_enabled = enable;
+}
+
+bool fbdev_is_page_flipping(void) {
+#if FBDEV_PAGE_FLIP
+    return page_flip;
+#else
+    return false;
+#endif
+}
+
+void fbdev_get_stats(fbdev_stats_t * out) {
+    *out = stats;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
 
+/*Pick the row converter from the framebuffer's depth and bitfields*/
+static void pixconv_init(void)
+{
+    pixconv = NULL;
+    mono_flags = (FBDEV_1BPP_DITHER ? FBDEV_MONO_DITHER : 0) | (FBDEV_1BPP_MSB_FIRST ? FBDEV_MONO_MSB_FIRST : 0);
+#if !USE_BSD_FBDEV
+    if(finfo.visual == FB_VISUAL_MONO01) mono_flags |= FBDEV_MONO_INVERT;
+#endif
+    if(vinfo.bits_per_pixel == 1) {
+        LV_LOG_INFO("Pixel pipeline: 1 bpp, %s", FBDEV_1BPP_DITHER ? "dithered" : "threshold");
+    }
+#if LV_COLOR_DEPTH == 16
+#if USE_BSD_FBDEV
+    uint32_t red_offset = vinfo.bits_per_pixel == 16 ? 11 : 16;
+    uint32_t blue_offset = 0;
+#else
+    uint32_t red_offset = vinfo.red.offset;
+    uint32_t blue_offset = vinfo.blue.offset;
+#endif
+    fbdev_pixfmt_t fmt = fbdev_pixconv_select(vinfo.bits_per_pixel, red_offset, blue_offset, LV_COLOR_16_SWAP);
+    pixconv = fbdev_pixconv_get(fmt);
+    pixconv_bytes = fbdev_pixfmt_bytes(fmt);
+    pixfmt = fmt;
+    if(pixconv) {
+        LV_LOG_INFO("Pixel pipeline: RGB565 -> %s (%s)", fbdev_pixfmt_name(fmt),
+                    fbdev_pixconv_impl_name(fbdev_pixconv_best(fmt)));
+    }
+    else if(vinfo.bits_per_pixel >= 16) {
+        /*1 and 8 bpp have no converter by design: the generic branches handle them*/
+        LV_LOG_WARN("No converter from RGB565 to %dbpp", vinfo.bits_per_pixel);
+    }
+#endif
+}
+
+/*The shadow only covers the converter path on a single, visible page*/
+static void shadow_init(void)
+{
+    shadow_pending = false;
+    if(!shadow_enabled || fbp == NULL) return;
+    if(pixconv == NULL || fbdev_is_page_flipping() || direct_mode || scale > 1) {
+        LV_LOG_WARN("Shadow framebuffer needs the single page converter path, not used");
+        return;
+    }
+
+    shadow_stride = vinfo.xres * pixconv_bytes;
+    shadow = malloc(shadow_stride * vinfo.yres);
+    shadow_scratch = malloc(shadow_stride);
+    if(shadow == NULL || shadow_scratch == NULL) {
+        LV_LOG_WARN("No memory for the shadow framebuffer, not used");
+        shadow_free();
+        return;
+    }
+
+    /*Start from what is on screen, so an unchanged first frame writes nothing*/
+    uint32_t y;
+    for(y = 0; y < vinfo.yres; y++) {
+        memcpy(shadow + y * shadow_stride,
+               fbp + (y + vinfo.yoffset) * finfo.line_length + vinfo.xoffset * pixconv_bytes, shadow_stride);
+    }
+    LV_LOG_INFO("Shadow framebuffer enabled (%d bytes)", shadow_stride * vinfo.yres);
+}
+
+/*Sized by fbdev_prepare(); only grows in the flush if an area is larger than announced.
+ *No logging: the flush may run on the worker thread.*/
+static bool rot_buf_reserve(uint32_t px)
+{
+    if(px <= rot_buf_px) return true;
+    lv_color_t * buf = realloc(rot_buf, px * sizeof(lv_color_t));
+    if(buf == NULL) return false;
+    rot_buf = buf;
+    rot_buf_px = px;
+    return true;
+}
+
+static void shadow_free(void)
+{
+    free(shadow);
+    free(shadow_scratch);
+    shadow = NULL;
+    shadow_scratch = NULL;
+}
+
+/*Black out the letterbox around the scaled picture; the picture itself is drawn by LVGL*/
+static void clear_borders(uint32_t yoffset)
+{
+    uint32_t pic_w = scale_hor_res * scale;
+    uint32_t pic_h = scale_ver_res * scale;
+    uint32_t row_bytes = vinfo.xres * pixconv_bytes;
+    uint8_t * row = (uint8_t *)fbp + yoffset * finfo.line_length + vinfo.xoffset * pixconv_bytes;
+    uint32_t y;
+    for(y = 0; y < vinfo.yres; y++) {
+        if(y < scale_y0 || y >= scale_y0 + pic_h) {
+            memset(row, 0, row_bytes);
+        }
+        else {
+            memset(row, 0, scale_x0 * pixconv_bytes);
+            memset(row + (scale_x0 + pic_w) * pixconv_bytes, 0, (vinfo.xres - scale_x0 - pic_w) * pixconv_bytes);
+        }
+        row += finfo.line_length;
+    }
+}
+
+static inline bool block_equal16(const uint8_t * a, const uint8_t * b)
+{
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    uint8x16_t x = veorq_u8(vld1q_u8(a), vld1q_u8(b));
+    uint32x2_t r = vreinterpret_u32_u8(vorr_u8(vget_low_u8(x), vget_high_u8(x)));
+    return (vget_lane_u32(r, 0) | vget_lane_u32(r, 1)) == 0;
+#elif defined(__SSE2__)
+    __m128i x = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)a), _mm_loadu_si128((const __m128i *)b));
+    return _mm_movemask_epi8(x) == 0xFFFF;
+#else
+    uint64_t a0, a1, b0, b1;
+    memcpy(&a0, a, 8);
+    memcpy(&a1, a + 8, 8);
+    memcpy(&b0, b, 8);
+    memcpy(&b1, b + 8, 8);
+    return ((a0 ^ b0) | (a1 ^ b1)) == 0;
+#endif
+}
+
+/*Convert a row, compare it with the shadow in 16 byte blocks and write only the changed spans*/
+static void shadow_write_row(uint8_t * dst, uint8_t * shadow_row, const uint16_t * src, uint32_t w)
+{
+    uint32_t len = w * pixconv_bytes;
+    uint32_t blocks = (len + 15) / 16;
+    pixconv(shadow_scratch, src, w);
+
+    uint32_t i = 0;
+    while(i < blocks) {
+        /*Skip unchanged blocks; the last one may be partial*/
+        while(i < blocks) {
+            uint32_t ofs = i * 16;
+            bool same = ofs + 16 <= len ? block_equal16(shadow_scratch + ofs, shadow_row + ofs)
+                                        : memcmp(shadow_scratch + ofs, shadow_row + ofs, len - ofs) == 0;
+            if(!same) break;
+            i++;
+        }
+        if(i == blocks) break;
+
+        /*Extend the span until FBDEV_SHADOW_GAP_BLOCKS unchanged blocks in a row*/
+        uint32_t start = i;
+        uint32_t end = i + 1;
+        uint32_t gap = 0;
+        for(i = end; i < blocks && gap < FBDEV_SHADOW_GAP_BLOCKS; i++) {
+            uint32_t ofs = i * 16;
+            bool same = ofs + 16 <= len ? block_equal16(shadow_scratch + ofs, shadow_row + ofs)
+                                        : memcmp(shadow_scratch + ofs, shadow_row + ofs, len - ofs) == 0;
+            if(same) gap++;
+            else {
+                gap = 0;
+                end = i + 1;
+            }
+        }
+        i = end;
+
+        uint32_t ofs = start * 16;
+        uint32_t span = (end * 16 > len ? len : end * 16) - ofs;
+        fbdev_copy(dst + ofs, shadow_scratch + ofs, span);
+        memcpy(shadow_row + ofs, shadow_scratch + ofs, span);
+        stats.write_bytes += span;
+        frame_write_bytes += span;
+    }
+}
+
+/*Can an lv_color_t buffer be shown as is?*/
+static bool format_matches_lv_color(void)
+{
+    if(vinfo.bits_per_pixel != LV_COLOR_DEPTH) return false;
+#if USE_BSD_FBDEV
+    return LV_COLOR_DEPTH != 16 || !LV_COLOR_16_SWAP;
+#else
+#if LV_COLOR_DEPTH == 16
+    return !LV_COLOR_16_SWAP &&
+           vinfo.red.offset == 11 && vinfo.red.length == 5 &&
+           vinfo.green.offset == 5 && vinfo.green.length == 6 &&
+           vinfo.blue.offset == 0 && vinfo.blue.length == 5;
+#elif LV_COLOR_DEPTH == 32
+    return vinfo.red.offset == 16 && vinfo.green.offset == 8 && vinfo.blue.offset == 0;
+#else
+    return true;
+#endif
+#endif
+}
+
+#if !USE_BSD_FBDEV
+/*Ask for LV_COLOR_DEPTH and, for page flipping, two pages; fall back to one of them, then to nothing*/
+static void mode_negotiate(void)
+{
+    orig_vinfo = vinfo;
+    bool want_depth = (LV_COLOR_DEPTH == 16 || LV_COLOR_DEPTH == 32) && vinfo.bits_per_pixel != LV_COLOR_DEPTH;
+    bool want_pages = FBDEV_PAGE_FLIP && vinfo.yres_virtual < vinfo.yres * 2;
+    if(!want_depth && !want_pages) {
+        LV_LOG_INFO("Mode already suits: %dbpp, yres_virtual %d", vinfo.bits_per_pixel, vinfo.yres_virtual);
+        return;
+    }
+
+    bool ok = mode_try(want_depth, want_pages);
+    if(!ok && want_depth && want_pages) ok = mode_try(true, false) || mode_try(false, true);
+    if(!ok) {
+        LV_LOG_WARN("Mode change refused, keeping %dbpp, yres_virtual %d", vinfo.bits_per_pixel, vinfo.yres_virtual);
+        return;
+    }
+
+    /*The stride and the mapped size follow the mode*/
+    if(ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo) == -1) perror("Error reading fixed information");
+    mode_changed = true;
+    LV_LOG_WARN("Mode changed from %dbpp, yres_virtual %d to %dbpp, yres_virtual %d",
+                orig_vinfo.bits_per_pixel, orig_vinfo.yres_virtual, vinfo.bits_per_pixel, vinfo.yres_virtual);
+}
+
+static bool mode_try(bool depth, bool pages)
+{
+    struct fb_var_screeninfo v = orig_vinfo;
+    if(depth) {
+        v.bits_per_pixel = LV_COLOR_DEPTH;
+        v.grayscale = 0;
+        memset(&v.transp, 0, sizeof(v.transp));
+        if(LV_COLOR_DEPTH == 16) {
+            v.red.offset = 11;
+            v.red.length = 5;
+            v.green.offset = 5;
+            v.green.length = 6;
+            v.blue.offset = 0;
+            v.blue.length = 5;
+        }
+        else {
+            v.red.offset = 16;
+            v.red.length = 8;
+            v.green.offset = 8;
+            v.green.length = 8;
+            v.blue.offset = 0;
+            v.blue.length = 8;
+            v.transp.offset = 24;
+            v.transp.length = 8;
+        }
+    }
+    if(pages) {
+        v.yres_virtual = v.yres * 2;
+        v.yoffset = 0;
+    }
+    v.activate = FB_ACTIVATE_NOW;
+    if(ioctl(fbfd, FBIOPUT_VSCREENINFO, &v) != 0) return false;
+
+    /*Drivers may adjust a request instead of refusing it: check what was set*/
+    struct fb_var_screeninfo got;
+    if(ioctl(fbfd, FBIOGET_VSCREENINFO, &got) != 0 ||
+       got.xres != orig_vinfo.xres || got.yres != orig_vinfo.yres ||
+       (depth && got.bits_per_pixel != LV_COLOR_DEPTH) || (pages && got.yres_virtual < got.yres * 2)) {
+        ioctl(fbfd, FBIOPUT_VSCREENINFO, &orig_vinfo);
+        return false;
+    }
+    vinfo = got;
+    return true;
+}
+#endif
+
+#if FBDEV_PAGE_FLIP
+static void page_flip_init(void)
+{
+    page_flip = false;
+    if(vinfo.yres_virtual < vinfo.yres * 2 || finfo.ypanstep == 0 ||
+       (long)finfo.line_length * vinfo.yres * 2 > screensize) {
+        LV_LOG_INFO("Page flipping not available (yres_virtual %d, ypanstep %d)", vinfo.yres_virtual, finfo.ypanstep);
+        return;
+    }
+
+    /*Keep whichever page is on screen now (it may hold a splash) as the front page*/
+    uint32_t front = vinfo.yoffset >= vinfo.yres ? vinfo.yres : 0;
+    uint32_t old = vinfo.yoffset;
+    vinfo.yoffset = front;
+    if(ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo) != 0) {
+        perror("ioctl(FBIOPAN_DISPLAY)");
+        vinfo.yoffset = old;
+        return;
+    }
+
+    back_yoffset = front ? 0 : vinfo.yres;
+    dirty_cnt = 0;
+    dirty_full = true;  /*The back page holds garbage until the first frame is synced*/
+    page_flip = true;
+    LV_LOG_INFO("Page flipping enabled, front page at line %d", front);
+}
+
+static void page_flip_present(void)
+{
+    uint32_t front = vinfo.yoffset;
+    vinfo.yoffset = back_yoffset;
+    if(ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo) != 0) {
+        /*The driver stopped panning: copy what was drawn to the visible page and stay there*/
+        perror("ioctl(FBIOPAN_DISPLAY)");
+        vinfo.yoffset = front;
+        page_flip = false;
+        lv_area_t full = {0, 0, vinfo.xres - 1, vinfo.yres - 1};
+        if(dirty_full) copy_area(front, back_yoffset, &full);
+        else for(uint32_t i = 0; i < dirty_cnt; i++) copy_area(front, back_yoffset, &dirty[i]);
+        return;
+    }
+    stats.flips++;
+
+#if FBDEV_WAIT_VSYNC && defined(FBIO_WAITFORVSYNC)
+    /*Don't touch the old front page before the controller has switched away from it*/
+    if(vsync_ok) {
+        uint32_t crtc = 0;
+        if(ioctl(fbfd, FBIO_WAITFORVSYNC, &crtc) == 0) {
+            stats.vsync_waits++;
+        } else {
+            perror("ioctl(FBIO_WAITFORVSYNC)");
+            vsync_ok = false;
+        }
+    }
+#endif
+
+    /*The old front page becomes the back page; bring it up to date with this frame*/
+    back_yoffset = front;
+    if(dirty_full) {
+        lv_area_t full = {0, 0, vinfo.xres - 1, vinfo.yres - 1};
+        copy_area(back_yoffset, vinfo.yoffset, &full);
+    } else {
+        for(uint32_t i = 0; i < dirty_cnt; i++) copy_area(back_yoffset, vinfo.yoffset, &dirty[i]);
+    }
+    dirty_cnt = 0;
+    dirty_full = false;
+}
+
+static void dirty_add(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    if(dirty_full) return;
+    if(dirty_cnt == FBDEV_DIRTY_MAX) {
+        dirty_full = true;
+        return;
+    }
+    lv_area_t * a = &dirty[dirty_cnt++];
+    a->x1 = x1;
+    a->y1 = y1;
+    a->x2 = x2;
+    a->y2 = y2;
+}
+
+/*Copy an area (screen coordinates) between the two pages*/
+static void copy_area(uint32_t dst_yoffset, uint32_t src_yoffset, const lv_area_t * area)
+{
+    /*Whole bytes; for 1 bpp this may include a few neighbouring pixels, which are identical anyway*/
+    uint32_t x_byte1 = ((area->x1 + vinfo.xoffset) * vinfo.bits_per_pixel) / 8;
+    uint32_t x_byte2 = ((area->x2 + 1 + vinfo.xoffset) * vinfo.bits_per_pixel + 7) / 8;
+    uint32_t len = x_byte2 - x_byte1;
+    int32_t y;
+    for(y = area->y1; y <= area->y2; y++) {
+        fbdev_copy(fbp + (y + dst_yoffset) * finfo.line_length + x_byte1,
+                   fbp + (y + src_yoffset) * finfo.line_length + x_byte1, len);
+    }
+    stats.sync_bytes += (uint64_t)len * (area->y2 - area->y1 + 1);
+}
+#endif /*FBDEV_PAGE_FLIP*/
+
 #endif
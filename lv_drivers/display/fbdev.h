@@ -29,6 +29,8 @@ extern "C" {
 #include "lvgl/lvgl.h"
 #endif
 
+#include "fbdev_rotate.h"
+
 /*********************
  *      DEFINES
  *********************/
@@ -36,20 +38,145 @@ extern "C" {
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct {
+    uint32_t flushes;       /*flush_cb calls*/
+    uint32_t frames;        /*Refreshes (last flush of a frame)*/
+    uint32_t flips;         /*Successful FBIOPAN_DISPLAY page flips*/
+    uint32_t vsync_waits;   /*Successful FBIO_WAITFORVSYNC calls*/
+    uint64_t copy_bytes;    /*Bytes rendered by LVGL and handed to the framebuffer (0 in direct mode)*/
+    uint64_t write_bytes;   /*Bytes actually stored to the framebuffer; less than copy_bytes with the shadow*/
+    uint32_t last_frame_copy_bytes;
+    uint32_t last_frame_write_bytes;
+    uint64_t sync_bytes;    /*Bytes copied between the pages to keep them in sync*/
+    uint32_t dropped;       /*Areas not drawn for lack of memory for the rotation buffer*/
+} fbdev_stats_t;
+
+/*A memory-backed stand-in for the framebuffer device, see fbdev_set_file()*/
+typedef struct {
+    char path[128];             /*Regular file to map, e.g. in /dev/shm; created or grown as needed*/
+    uint32_t xres;
+    uint32_t yres;
+    uint32_t bits_per_pixel;    /*1, 8, 16, 24 or 32*/
+    uint32_t line_length;       /*Bytes per row including padding*/
+    uint32_t xoffset;           /*Visible screen's position in the virtual screen*/
+    uint32_t yoffset;
+    bool bgr;                   /*Blue in the high bits (BGR565, XBGR8888, BGR888)*/
+} fbdev_file_t;
 
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
 void fbdev_init(void);
 void fbdev_exit(void);
+/**
+ * @return true if fbdev_init() switched the mode (see fbdev_set_negotiate()) and it is not restored yet
+ */
+bool fbdev_mode_changed(void);
+/**
+ * Put back the mode found at fbdev_init(). Async-signal-safe: a single ioctl, no unmapping and
+ * no output, so it may run in a SIGTERM handler while the flush worker writes to the framebuffer.
+ */
+void fbdev_restore_mode(void);
 void fbdev_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
 void fbdev_get_sizes(uint32_t *width, uint32_t *height);
+/**
+ * Blank or unblank the display with FBIOBLANK. The framebuffer content is kept.
+ * @param blank true: power the panel down, false: switch it back on
+ * @return false if the device is not open or the driver refused the request
+ */
+bool fbdev_blank(bool blank);
+/**
+ * Size of the visible screen in the framebuffer's native format, rows packed without padding.
+ * @return bytes needed by fbdev_read_screen() / fbdev_write_screen(), 0 if not mapped
+ */
+uint32_t fbdev_get_screen_bytes(void);
+uint32_t fbdev_get_bpp(void);
+/**
+ * Copy the visible screen out of the framebuffer
+ * @param buf fbdev_get_screen_bytes() bytes
+ */
+bool fbdev_read_screen(void * buf);
+/**
+ * Copy a full screen (as returned by fbdev_read_screen()) into the framebuffer
+ * @param buf fbdev_get_screen_bytes() bytes
+ */
+bool fbdev_write_screen(const void * buf);
 /**
  * Set the X and Y offset in the variable framebuffer info.
  * @param xoffset horizontal offset
  * @param yoffset vertical offset
  */
 void fbdev_set_offset(uint32_t xoffset, uint32_t yoffset);
+/**
+ * Let LVGL render straight into the mapped framebuffer (use with `direct_mode = 1`).
+ * Only possible when the framebuffer has lv_color_t's format, no row padding and the given size.
+ * @param hor_res horizontal resolution of the display driver
+ * @param ver_res vertical resolution of the display driver
+ * @param buf1 receives the first draw buffer (the back page when page flipping)
+ * @param buf2 receives the second draw buffer (the front page) or NULL without page flipping
+ * @return false if LVGL needs its own buffer and the copy path (always with the shadow, see fbdev_set_shadow())
+ */
+bool fbdev_direct_init(lv_coord_t hor_res, lv_coord_t ver_res, void ** buf1, void ** buf2);
+/**
+ * Rotate the picture clockwise on the panel, for enclosures that mount it sideways or upside down.
+ * Call before fbdev_set_scale() and fbdev_direct_init(). With 90/270 degrees the display driver's
+ * resolution is the screen's with width and height exchanged. Rules out direct mode.
+ */
+void fbdev_set_rotation(fbdev_rotation_t rot);
+fbdev_rotation_t fbdev_get_rotation(void);
+/**
+ * Render at a logical resolution and upscale by an integer factor (nearest neighbour) in the flush,
+ * centred on the screen with black borders. Call after fbdev_init() and before fbdev_direct_init();
+ * the display driver then uses the logical resolution. Needs the converter path (16 bit LVGL colours).
+ * @param hor_res logical horizontal resolution
+ * @param ver_res logical vertical resolution
+ * @param factor 0: the largest factor that fits (at most FBDEV_SCALE_MAX), 1: no scaling
+ * @return the factor in use, 1 if not scaling
+ */
+uint32_t fbdev_set_scale(lv_coord_t hor_res, lv_coord_t ver_res, uint32_t factor);
+/**
+ * Allocate what the flush needs: the shadow (see fbdev_set_shadow()) and the rotation buffer.
+ * Call on the UI thread after fbdev_set_scale() and fbdev_direct_init(), before the first flush.
+ * fbdev_flush() then neither sets anything up nor logs through LVGL, so it may run on another thread.
+ * @param max_area_px largest area LVGL will flush (the draw buffer size in pixels)
+ */
+void fbdev_prepare(uint32_t max_area_px);
+/**
+ * @return short description of the path flushes take, e.g. "RGB565 -> XRGB8888 (neon)" or "direct"
+ */
+const char * fbdev_get_pipeline(void);
+/**
+ * Let fbdev_init() switch the framebuffer to LV_COLOR_DEPTH and, with FBDEV_PAGE_FLIP, to two pages
+ * (FBIOPUT_VSCREENINFO). Falls back to whatever the driver accepts; fbdev_exit() restores the
+ * original mode. Call before fbdev_init(). Not available with USE_BSD_FBDEV.
+ */
+void fbdev_set_negotiate(bool enable);
+/**
+ * Let fbdev_init() map a regular file (e.g. in /dev/shm) instead of FBDEV_PATH and describe it with
+ * the given geometry instead of the device's screen info. Blanking, page flipping and mode
+ * negotiation are not available. For measuring the flush path without a panel.
+ * Call before fbdev_init().
+ * @param file geometry and path, NULL: use FBDEV_PATH again
+ */
+void fbdev_set_file(const fbdev_file_t * file);
+/**
+ * Parse "PATH,WIDTHxHEIGHT,BPP[,stride=BYTES][,xoffset=N][,yoffset=N][,bgr]"
+ * @param file filled in; line_length defaults to packed rows
+ * @return false if the spec is malformed or the stride is too small for the row
+ */
+bool fbdev_file_parse(const char * spec, fbdev_file_t * file);
+/**
+ * Keep a RAM shadow of the screen and only write pixels that changed, for framebuffers where
+ * every written byte costs bus traffic (fbtft / deferred I/O). Call before fbdev_init().
+ * Only used with the converter path on a single page, without upscaling; it is set up by
+ * fbdev_prepare() and rules out direct mode.
+ */
+void fbdev_set_shadow(bool enable);
+/**
+ * @return true if frames are rendered into a back page and shown with FBIOPAN_DISPLAY
+ */
+bool fbdev_is_page_flipping(void);
+void fbdev_get_stats(fbdev_stats_t * stats);
 
 
 /**********************
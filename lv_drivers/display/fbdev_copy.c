@@ -0,0 +1,119 @@
+/**
+ * @file fbdev_copy.c
+ * Copy into mapped framebuffer memory (write-combined or uncached)
+ *
+ * A generic memcpy() is tuned for cached memory: on a write-combined mapping its small or
+ * misaligned stores flush partial bursts, and on x86 every destination line is read before it
+ * is written. Here the destination is aligned once and then written in whole 64 byte bursts.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "fbdev_copy.h"
+#if USE_FBDEV || USE_BSD_FBDEV
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define COPY_HAVE_NEON 1
+#else
+#define COPY_HAVE_NEON 0
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define COPY_HAVE_SSE2 1
+#else
+#define COPY_HAVE_SSE2 0
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define COPY_BURST 64
+
+/*Below this a burst loop does not pay for its setup*/
+#define COPY_MIN_STREAM 128
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void fbdev_copy(void * dst, const void * src, size_t n)
+{
+#if FBDEV_COPY_STREAM
+    fbdev_copy_stream(dst, src, n);
+#else
+    memcpy(dst, src, n);
+#endif
+}
+
+void fbdev_copy_stream(void * dst, const void * src, size_t n)
+{
+    uint8_t * d = dst;
+    const uint8_t * s = src;
+    if(n < COPY_MIN_STREAM) {
+        memcpy(d, s, n);
+        return;
+    }
+
+    /*Head: up to the next 16 byte boundary of the destination*/
+    size_t head = (size_t)(-(uintptr_t)d) & 15;
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+#if COPY_HAVE_NEON
+    for(; n >= COPY_BURST; n -= COPY_BURST, d += COPY_BURST, s += COPY_BURST) {
+        uint8x16_t v0 = vld1q_u8(s);
+        uint8x16_t v1 = vld1q_u8(s + 16);
+        uint8x16_t v2 = vld1q_u8(s + 32);
+        uint8x16_t v3 = vld1q_u8(s + 48);
+        vst1q_u8(d, v0);
+        vst1q_u8(d + 16, v1);
+        vst1q_u8(d + 32, v2);
+        vst1q_u8(d + 48, v3);
+    }
+#elif COPY_HAVE_SSE2
+    for(; n >= COPY_BURST; n -= COPY_BURST, d += COPY_BURST, s += COPY_BURST) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)s);
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(s + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(s + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i *)(s + 48));
+        _mm_stream_si128((__m128i *)d, v0);
+        _mm_stream_si128((__m128i *)(d + 16), v1);
+        _mm_stream_si128((__m128i *)(d + 32), v2);
+        _mm_stream_si128((__m128i *)(d + 48), v3);
+    }
+    /*Non-temporal stores are weakly ordered: finish them before anyone looks at the picture*/
+    _mm_sfence();
+#else
+    for(; n >= COPY_BURST; n -= COPY_BURST, d += COPY_BURST, s += COPY_BURST) {
+        uint32_t w[COPY_BURST / 4];
+        memcpy(w, s, COPY_BURST);   /*Unaligned source, aligned word stores*/
+        uint32_t * dw = (uint32_t *)(void *)d;
+        int i;
+        for(i = 0; i < COPY_BURST / 4; i++) dw[i] = w[i];
+    }
+#endif
+
+    /*Tail*/
+    memcpy(d, s, n);
+}
+
+const char * fbdev_copy_impl_name(void)
+{
+#if COPY_HAVE_NEON
+    return "neon";
+#elif COPY_HAVE_SSE2
+    return "sse2";
+#else
+    return "portable";
+#endif
+}
+
+#endif /*USE_FBDEV || USE_BSD_FBDEV*/
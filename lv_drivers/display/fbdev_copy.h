@@ -0,0 +1,73 @@
+/**
+ * @file fbdev_copy.h
+ * Copy into mapped framebuffer memory (write-combined or uncached)
+ */
+
+#ifndef FBDEV_COPY_H
+#define FBDEV_COPY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#ifndef LV_DRV_NO_CONF
+#ifdef LV_CONF_INCLUDE_SIMPLE
+#include "lv_drv_conf.h"
+#else
+#include "../../lv_drv_conf.h"
+#endif
+#endif
+
+#if USE_FBDEV || USE_BSD_FBDEV
+
+#include <stddef.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+/*1: fbdev_copy() uses fbdev_copy_stream(), 0: the C library's memcpy()*/
+#ifndef FBDEV_COPY_STREAM
+#define FBDEV_COPY_STREAM 1
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Copy into the framebuffer with the implementation selected by FBDEV_COPY_STREAM.
+ * Every plain copy of the flush path goes through here.
+ */
+void fbdev_copy(void * dst, const void * src, size_t n);
+
+/**
+ * Copy for memory that is written but never read back by the CPU: the destination is aligned
+ * first, then written in 64 byte bursts of full-width stores (NEON vst1, SSE2 non-temporal
+ * stores), so a write-combining buffer is always filled completely and no line is read for
+ * ownership. The unaligned head and the tail are copied with memcpy().
+ */
+void fbdev_copy_stream(void * dst, const void * src, size_t n);
+
+/**
+ * Name of the burst implementation built into fbdev_copy_stream(): "neon", "sse2" or "portable"
+ */
+const char * fbdev_copy_impl_name(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif  /*USE_FBDEV || USE_BSD_FBDEV*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*FBDEV_COPY_H*/
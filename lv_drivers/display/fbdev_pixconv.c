@@ -0,0 +1,679 @@
+/**
+ * @file fbdev_pixconv.c
+ * Row converters from LVGL's RGB565 buffers to the framebuffer's pixel format
+ *
+ * Formats are defined on the pixel value in CPU (little-endian) byte order, like fbdev's bitfields.
+ * 5 and 6 bit channels are widened by replicating their top bits, so white stays 0xFF.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "fbdev_pixconv.h"
+#if USE_FBDEV || USE_BSD_FBDEV
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXCONV_HAVE_NEON 1
+#else
+#define PIXCONV_HAVE_NEON 0
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXCONV_HAVE_SSE2 1
+#else
+#define PIXCONV_HAVE_SSE2 0
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SELFTEST_PIXELS 65536
+#define SELFTEST_GUARD  0xA5
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void ref_pixel(fbdev_pixfmt_t fmt, uint16_t px, uint8_t * out);
+static bool selftest_one(fbdev_pixfmt_t fmt, fbdev_pixconv_impl_t impl, fbdev_pixconv_fn_t fn,
+                         const uint16_t * src, uint8_t * dst, uint8_t * ref);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * const fmt_names[FBDEV_PIXFMT_CNT] = {
+    "RGB565", "RGB565 (swapped)", "BGR565", "XRGB8888", "XBGR8888", "RGB888", "BGR888"
+};
+
+static const uint8_t fmt_bytes[FBDEV_PIXFMT_CNT] = {2, 2, 2, 4, 4, 3, 3};
+
+static const char * const impl_names[FBDEV_PIXCONV_IMPL_CNT] = {"portable", "neon", "sse2"};
+
+/*4x4 Bayer thresholds (index * 16 + 8), each row repeated to cover a byte of pixels*/
+static const uint8_t mono_dither[4][8] = {
+    {  8, 136,  40, 168,   8, 136,  40, 168},
+    {200,  72, 232, 104, 200,  72, 232, 104},
+    { 56, 184,  24, 152,  56, 184,  24, 152},
+    {248, 120, 216,  88, 248, 120, 216,  88},
+};
+static const uint8_t mono_half[8] = {128, 128, 128, 128, 128, 128, 128, 128};
+
+/**********************
+ *   PORTABLE KERNELS
+ **********************/
+#define EXPAND_R(px) ((uint8_t)((((px) >> 8) & 0xF8) | ((px) >> 13)))
+#define EXPAND_G(px) ((uint8_t)((((px) >> 3) & 0xFC) | (((px) >> 9) & 0x03)))
+#define EXPAND_B(px) ((uint8_t)((((px) << 3) & 0xF8) | (((px) >> 2) & 0x07)))
+
+static void copy_rgb565(void * dst, const uint16_t * src, uint32_t n)
+{
+    memcpy(dst, src, n * 2);
+}
+
+static void portable_rgb565_swap(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    while(n--) {
+        uint16_t px = *src++;
+        d[0] = px >> 8;
+        d[1] = px & 0xFF;
+        d += 2;
+    }
+}
+
+static void portable_bgr565(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    while(n--) {
+        uint16_t px = *src++;
+        uint16_t out = (uint16_t)((px << 11) | (px & 0x07E0) | (px >> 11));
+        memcpy(d, &out, 2);
+        d += 2;
+    }
+}
+
+static void portable_xrgb8888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    while(n--) {
+        uint16_t px = *src++;
+        uint32_t out = 0xFF000000u | ((uint32_t)EXPAND_R(px) << 16) | ((uint32_t)EXPAND_G(px) << 8) | EXPAND_B(px);
+        memcpy(d, &out, 4);
+        d += 4;
+    }
+}
+
+static void portable_xbgr8888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    while(n--) {
+        uint16_t px = *src++;
+        uint32_t out = 0xFF000000u | ((uint32_t)EXPAND_B(px) << 16) | ((uint32_t)EXPAND_G(px) << 8) | EXPAND_R(px);
+        memcpy(d, &out, 4);
+        d += 4;
+    }
+}
+
+static void portable_rgb888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    while(n--) {
+        uint16_t px = *src++;
+        d[0] = EXPAND_B(px);
+        d[1] = EXPAND_G(px);
+        d[2] = EXPAND_R(px);
+        d += 3;
+    }
+}
+
+static void portable_bgr888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    while(n--) {
+        uint16_t px = *src++;
+        d[0] = EXPAND_R(px);
+        d[1] = EXPAND_G(px);
+        d[2] = EXPAND_B(px);
+        d += 3;
+    }
+}
+
+/**********************
+ *    NEON KERNELS
+ **********************/
+#if PIXCONV_HAVE_NEON
+static inline void neon_expand(uint16x8_t v, uint8x8_t * r, uint8x8_t * g, uint8x8_t * b)
+{
+    uint8x8_t r5 = vand_u8(vshrn_n_u16(v, 8), vdup_n_u8(0xF8));
+    uint8x8_t g6 = vand_u8(vshrn_n_u16(v, 3), vdup_n_u8(0xFC));
+    uint8x8_t b5 = vmovn_u16(vshlq_n_u16(v, 3));
+    *r = vorr_u8(r5, vshr_n_u8(r5, 5));
+    *g = vorr_u8(g6, vshr_n_u8(g6, 6));
+    *b = vorr_u8(b5, vshr_n_u8(b5, 5));
+}
+
+static void neon_rgb565_swap(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    for(; n >= 8; n -= 8, src += 8, d += 16) {
+        vst1q_u8(d, vrev16q_u8(vreinterpretq_u8_u16(vld1q_u16(src))));
+    }
+    portable_rgb565_swap(d, src, n);
+}
+
+static void neon_bgr565(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    for(; n >= 8; n -= 8, src += 8, d += 16) {
+        uint16x8_t v = vld1q_u16(src);
+        uint16x8_t out = vorrq_u16(vorrq_u16(vshlq_n_u16(v, 11), vandq_u16(v, vdupq_n_u16(0x07E0))),
+                                   vshrq_n_u16(v, 11));
+        vst1q_u8(d, vreinterpretq_u8_u16(out));
+    }
+    portable_bgr565(d, src, n);
+}
+
+static void neon_xrgb8888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    uint8x8x4_t o;
+    o.val[3] = vdup_n_u8(0xFF);
+    for(; n >= 8; n -= 8, src += 8, d += 32) {
+        neon_expand(vld1q_u16(src), &o.val[2], &o.val[1], &o.val[0]);
+        vst4_u8(d, o);
+    }
+    portable_xrgb8888(d, src, n);
+}
+
+static void neon_xbgr8888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    uint8x8x4_t o;
+    o.val[3] = vdup_n_u8(0xFF);
+    for(; n >= 8; n -= 8, src += 8, d += 32) {
+        neon_expand(vld1q_u16(src), &o.val[0], &o.val[1], &o.val[2]);
+        vst4_u8(d, o);
+    }
+    portable_xbgr8888(d, src, n);
+}
+
+static void neon_rgb888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    uint8x8x3_t o;
+    for(; n >= 8; n -= 8, src += 8, d += 24) {
+        neon_expand(vld1q_u16(src), &o.val[2], &o.val[1], &o.val[0]);
+        vst3_u8(d, o);
+    }
+    portable_rgb888(d, src, n);
+}
+
+static void neon_bgr888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    uint8x8x3_t o;
+    for(; n >= 8; n -= 8, src += 8, d += 24) {
+        neon_expand(vld1q_u16(src), &o.val[0], &o.val[1], &o.val[2]);
+        vst3_u8(d, o);
+    }
+    portable_bgr888(d, src, n);
+}
+#endif /*PIXCONV_HAVE_NEON*/
+
+/**********************
+ *    SSE2 KERNELS
+ **********************/
+#if PIXCONV_HAVE_SSE2
+/*Widened channels in the low byte of each 16 bit lane*/
+static inline void sse2_expand(__m128i v, __m128i * r, __m128i * g, __m128i * b)
+{
+    __m128i r5 = _mm_srli_epi16(v, 11);
+    __m128i g6 = _mm_and_si128(_mm_srli_epi16(v, 5), _mm_set1_epi16(0x3F));
+    __m128i b5 = _mm_and_si128(v, _mm_set1_epi16(0x1F));
+    *r = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+    *g = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+    *b = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+}
+
+static void sse2_rgb565_swap(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    for(; n >= 8; n -= 8, src += 8, d += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_si128((__m128i *)d, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+    portable_rgb565_swap(d, src, n);
+}
+
+static void sse2_bgr565(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    for(; n >= 8; n -= 8, src += 8, d += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(v, 11), _mm_and_si128(v, _mm_set1_epi16(0x07E0))),
+                                   _mm_srli_epi16(v, 11));
+        _mm_storeu_si128((__m128i *)d, out);
+    }
+    portable_bgr565(d, src, n);
+}
+
+/*lo | hi << 8 and c2 | 0xFF << 8 interleaved into 32 bit pixels: bytes lo, mid, c2, 0xFF*/
+static inline void sse2_store_x8888(uint8_t * d, __m128i c0, __m128i c1, __m128i c2)
+{
+    __m128i low = _mm_or_si128(c0, _mm_slli_epi16(c1, 8));
+    __m128i high = _mm_or_si128(c2, _mm_set1_epi16((short)0xFF00));
+    _mm_storeu_si128((__m128i *)d, _mm_unpacklo_epi16(low, high));
+    _mm_storeu_si128((__m128i *)(d + 16), _mm_unpackhi_epi16(low, high));
+}
+
+static void sse2_xrgb8888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    for(; n >= 8; n -= 8, src += 8, d += 32) {
+        __m128i r, g, b;
+        sse2_expand(_mm_loadu_si128((const __m128i *)src), &r, &g, &b);
+        sse2_store_x8888(d, b, g, r);
+    }
+    portable_xrgb8888(d, src, n);
+}
+
+static void sse2_xbgr8888(void * dst, const uint16_t * src, uint32_t n)
+{
+    uint8_t * d = dst;
+    for(; n >= 8; n -= 8, src += 8, d += 32) {
+        __m128i r, g, b;
+        sse2_expand(_mm_loadu_si128((const __m128i *)src), &r, &g, &b);
+        sse2_store_x8888(d, r, g, b);
+    }
+    portable_xbgr8888(d, src, n);
+}
+#endif /*PIXCONV_HAVE_SSE2*/
+
+/**********************
+ *   UPSCALE KERNELS
+ **********************/
+static void upscale_portable(uint16_t * dst, const uint16_t * src, uint32_t n, uint32_t factor)
+{
+    uint32_t i;
+    uint32_t k;
+    for(i = 0; i < n; i++) {
+        for(k = 0; k < factor; k++) *dst++ = src[i];
+    }
+}
+
+/*2x: NEON interleaves a vector with itself, SSE2 unpacks it with itself. 3x only has a NEON form*/
+static void upscale_x2(uint16_t * dst, const uint16_t * src, uint32_t n)
+{
+#if PIXCONV_HAVE_NEON
+    for(; n >= 8; n -= 8, src += 8, dst += 16) {
+        uint16x8_t v = vld1q_u16(src);
+        uint16x8x2_t d = {{v, v}};
+        vst2q_u16(dst, d);
+    }
+#elif PIXCONV_HAVE_SSE2
+    for(; n >= 8; n -= 8, src += 8, dst += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(v, v));
+        _mm_storeu_si128((__m128i *)(dst + 8), _mm_unpackhi_epi16(v, v));
+    }
+#endif
+    upscale_portable(dst, src, n, 2);
+}
+
+static void upscale_x3(uint16_t * dst, const uint16_t * src, uint32_t n)
+{
+#if PIXCONV_HAVE_NEON
+    for(; n >= 8; n -= 8, src += 8, dst += 24) {
+        uint16x8_t v = vld1q_u16(src);
+        uint16x8x3_t d = {{v, v, v}};
+        vst3q_u16(dst, d);
+    }
+#endif
+    upscale_portable(dst, src, n, 3);
+}
+
+/**********************
+ *    MONO KERNELS
+ **********************/
+/*
+ * Luminance 0..255 with Rec. 601 weights directly on the 5/6/5 bit fields (white gives 255).
+ * The sum stays below 65536, so the vector kernels can work in 16 bit lanes.
+ */
+#define MONO_WR 630
+#define MONO_WG 608
+#define MONO_WB 240
+
+static inline uint32_t luma565(uint16_t px)
+{
+    return ((px >> 11) * MONO_WR + ((px >> 5) & 0x3F) * MONO_WG + (px & 0x1F) * MONO_WB + 128) >> 8;
+}
+
+/*8 pixels to one byte, pixel i in bit i; set where the pixel is at least as bright as its threshold*/
+typedef uint8_t (*mono_pack8_fn_t)(const uint16_t * src, const uint8_t * thr);
+
+static uint8_t mono_pack8_portable(const uint16_t * src, const uint8_t * thr)
+{
+    uint8_t byte = 0;
+    int i;
+    for(i = 0; i < 8; i++) {
+        if(luma565(src[i]) >= thr[i]) byte |= (uint8_t)(1 << i);
+    }
+    return byte;
+}
+
+#if PIXCONV_HAVE_NEON
+static uint8_t mono_pack8_neon(const uint16_t * src, const uint8_t * thr)
+{
+    static const uint16_t weights[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+    uint16x8_t v = vld1q_u16(src);
+    uint16x8_t y = vmulq_n_u16(vshrq_n_u16(v, 11), MONO_WR);
+    y = vmlaq_n_u16(y, vandq_u16(vshrq_n_u16(v, 5), vdupq_n_u16(0x3F)), MONO_WG);
+    y = vmlaq_n_u16(y, vandq_u16(v, vdupq_n_u16(0x1F)), MONO_WB);
+    y = vshrq_n_u16(vaddq_u16(y, vdupq_n_u16(128)), 8);
+    uint16x8_t bits = vandq_u16(vcgeq_u16(y, vmovl_u8(vld1_u8(thr))), vld1q_u16(weights));
+    uint16x4_t sum = vpadd_u16(vget_low_u16(bits), vget_high_u16(bits));
+    sum = vpadd_u16(sum, sum);
+    sum = vpadd_u16(sum, sum);
+    return (uint8_t)vget_lane_u16(sum, 0);
+}
+#define MONO_PACK8_BEST mono_pack8_neon
+#elif PIXCONV_HAVE_SSE2
+static uint8_t mono_pack8_sse2(const uint16_t * src, const uint8_t * thr)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)src);
+    __m128i y = _mm_mullo_epi16(_mm_srli_epi16(v, 11), _mm_set1_epi16(MONO_WR));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(v, 5), _mm_set1_epi16(0x3F)),
+                                         _mm_set1_epi16(MONO_WG)));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi16(0x1F)), _mm_set1_epi16(MONO_WB)));
+    y = _mm_srli_epi16(_mm_add_epi16(y, _mm_set1_epi16(128)), 8);
+    /*0..255 in every lane: the signed compare is safe*/
+    __m128i t = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)thr), _mm_setzero_si128());
+    __m128i dark = _mm_cmplt_epi16(y, t);
+    return (uint8_t)~_mm_movemask_epi8(_mm_packs_epi16(dark, dark));
+}
+#define MONO_PACK8_BEST mono_pack8_sse2
+#else
+#define MONO_PACK8_BEST mono_pack8_portable
+#endif
+
+static inline uint8_t bit_reverse8(uint8_t b)
+{
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    return (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+}
+
+/*Merge `bits` (pixel i in bit i) into the bits selected by `mask` of a partially covered byte*/
+static inline void mono_store(uint8_t * dst, uint8_t bits, uint8_t mask, uint32_t flags)
+{
+    if(flags & FBDEV_MONO_INVERT) bits = (uint8_t)~bits;
+    if(flags & FBDEV_MONO_MSB_FIRST) {
+        bits = bit_reverse8(bits);
+        mask = bit_reverse8(mask);
+    }
+    if(mask == 0xFF) *dst = bits;
+    else *dst = (uint8_t)((*dst & ~mask) | (bits & mask));
+}
+
+static void mono_row(mono_pack8_fn_t pack8, uint8_t * dst, const uint16_t * src, uint32_t x, uint32_t n,
+                     uint32_t y, uint32_t flags)
+{
+    const uint8_t * thr = (flags & FBDEV_MONO_DITHER) ? mono_dither[y & 3] : mono_half;
+    dst += x / 8;
+
+    /*Leading partial byte*/
+    uint32_t bit = x & 7;
+    if(bit && n) {
+        uint8_t bits = 0;
+        uint8_t mask = 0;
+        for(; bit < 8 && n; bit++, n--, src++) {
+            if(luma565(*src) >= thr[bit]) bits |= (uint8_t)(1 << bit);
+            mask |= (uint8_t)(1 << bit);
+        }
+        mono_store(dst++, bits, mask, flags);
+    }
+
+    /*Whole bytes: written without reading the framebuffer*/
+    for(; n >= 8; n -= 8, src += 8) mono_store(dst++, pack8(src, thr), 0xFF, flags);
+
+    /*Trailing partial byte*/
+    if(n) {
+        uint8_t bits = 0;
+        uint8_t mask = 0;
+        for(bit = 0; bit < n; bit++) {
+            if(luma565(src[bit]) >= thr[bit]) bits |= (uint8_t)(1 << bit);
+            mask |= (uint8_t)(1 << bit);
+        }
+        mono_store(dst, bits, mask, flags);
+    }
+}
+
+/*Packed 24 bit has no cheap SSE2 form: those entries fall back to the portable kernels*/
+static const fbdev_pixconv_fn_t kernels[FBDEV_PIXCONV_IMPL_CNT][FBDEV_PIXFMT_CNT] = {
+    [FBDEV_PIXCONV_PORTABLE] = {
+        copy_rgb565, portable_rgb565_swap, portable_bgr565,
+        portable_xrgb8888, portable_xbgr8888, portable_rgb888, portable_bgr888
+    },
+#if PIXCONV_HAVE_NEON
+    [FBDEV_PIXCONV_NEON] = {
+        copy_rgb565, neon_rgb565_swap, neon_bgr565,
+        neon_xrgb8888, neon_xbgr8888, neon_rgb888, neon_bgr888
+    },
+#endif
+#if PIXCONV_HAVE_SSE2
+    [FBDEV_PIXCONV_SSE2] = {
+        copy_rgb565, sse2_rgb565_swap, sse2_bgr565,
+        sse2_xrgb8888, sse2_xbgr8888, NULL, NULL
+    },
+#endif
+};
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+fbdev_pixconv_fn_t fbdev_pixconv_get_impl(fbdev_pixfmt_t fmt, fbdev_pixconv_impl_t impl)
+{
+    if(fmt >= FBDEV_PIXFMT_CNT || impl >= FBDEV_PIXCONV_IMPL_CNT) return NULL;
+    return kernels[impl][fmt];
+}
+
+fbdev_pixconv_impl_t fbdev_pixconv_best(fbdev_pixfmt_t fmt)
+{
+    if(fmt < FBDEV_PIXFMT_CNT) {
+        if(kernels[FBDEV_PIXCONV_NEON][fmt]) return FBDEV_PIXCONV_NEON;
+        if(kernels[FBDEV_PIXCONV_SSE2][fmt]) return FBDEV_PIXCONV_SSE2;
+    }
+    return FBDEV_PIXCONV_PORTABLE;
+}
+
+fbdev_pixconv_fn_t fbdev_pixconv_get(fbdev_pixfmt_t fmt)
+{
+    return fbdev_pixconv_get_impl(fmt, fbdev_pixconv_best(fmt));
+}
+
+fbdev_pixfmt_t fbdev_pixconv_select(uint32_t bits_per_pixel, uint32_t red_offset, uint32_t blue_offset, bool swapped)
+{
+    /*Only 16 bit sources can be widened; a byte-swapped source is only supported towards RGB565*/
+    bool rgb = red_offset > blue_offset;
+    switch(bits_per_pixel) {
+        case 16:
+            if(swapped) return rgb ? FBDEV_PIXFMT_RGB565_SWAP : FBDEV_PIXFMT_CNT;
+            return rgb ? FBDEV_PIXFMT_RGB565 : FBDEV_PIXFMT_BGR565;
+        case 24:
+            if(swapped) return FBDEV_PIXFMT_CNT;
+            return rgb ? FBDEV_PIXFMT_RGB888 : FBDEV_PIXFMT_BGR888;
+        case 32:
+            if(swapped) return FBDEV_PIXFMT_CNT;
+            return rgb ? FBDEV_PIXFMT_XRGB8888 : FBDEV_PIXFMT_XBGR8888;
+        default:
+            return FBDEV_PIXFMT_CNT;
+    }
+}
+
+uint32_t fbdev_pixfmt_bytes(fbdev_pixfmt_t fmt)
+{
+    return fmt < FBDEV_PIXFMT_CNT ? fmt_bytes[fmt] : 0;
+}
+
+const char * fbdev_pixfmt_name(fbdev_pixfmt_t fmt)
+{
+    return fmt < FBDEV_PIXFMT_CNT ? fmt_names[fmt] : "unsupported";
+}
+
+const char * fbdev_pixconv_impl_name(fbdev_pixconv_impl_t impl)
+{
+    return impl < FBDEV_PIXCONV_IMPL_CNT ? impl_names[impl] : "?";
+}
+
+void fbdev_pixconv_upscale_row(uint16_t * dst, const uint16_t * src, uint32_t n, uint32_t factor)
+{
+    if(factor == 2) upscale_x2(dst, src, n);
+    else if(factor == 3) upscale_x3(dst, src, n);
+    else upscale_portable(dst, src, n, factor);
+}
+
+void fbdev_pixconv_mono_row(uint8_t * dst, const uint16_t * src, uint32_t x, uint32_t n, uint32_t y, uint32_t flags)
+{
+    mono_row(MONO_PACK8_BEST, dst, src, x, n, y, flags);
+}
+
+int fbdev_pixconv_selftest(void)
+{
+    /*+8 pixels / bytes of slack for the misaligned runs and the guard bytes*/
+    uint16_t * src = malloc((SELFTEST_PIXELS + 8) * sizeof(uint16_t));
+    uint8_t * dst = malloc(SELFTEST_PIXELS * 4 + 8);
+    uint8_t * ref = malloc(SELFTEST_PIXELS * 4 + 8);
+    if(!src || !dst || !ref) {
+        free(src);
+        free(dst);
+        free(ref);
+        return -1;
+    }
+
+    uint32_t i;
+    for(i = 0; i < SELFTEST_PIXELS + 8; i++) src[i] = (uint16_t)i;
+
+    int failed = 0;
+    int impl;
+    int fmt;
+    for(impl = 0; impl < FBDEV_PIXCONV_IMPL_CNT; impl++) {
+        for(fmt = 0; fmt < FBDEV_PIXFMT_CNT; fmt++) {
+            fbdev_pixconv_fn_t fn = kernels[impl][fmt];
+            if(fn == NULL) continue;
+            if(!selftest_one(fmt, impl, fn, src, dst, ref)) failed++;
+        }
+    }
+
+    /*Upscaling: odd lengths and a misaligned source against the plain loop*/
+    uint32_t factor;
+    for(factor = 2; factor <= 4; factor++) {
+        uint32_t n;
+        for(n = 0; n <= 37; n++) {
+            fbdev_pixconv_upscale_row((uint16_t *)dst, src + 1, n, factor);
+            upscale_portable((uint16_t *)ref, src + 1, n, factor);
+            if(memcmp(dst, ref, n * factor * sizeof(uint16_t)) != 0) {
+                fprintf(stderr, "pixconv selftest: %ux upscale failed for %u pixels\n", factor, n);
+                failed++;
+                break;
+            }
+        }
+    }
+
+    /*1 bpp packing: every start bit and length, both modes, against the scalar packer*/
+    uint32_t flags;
+    for(flags = 0; flags <= FBDEV_MONO_DITHER; flags++) {
+        uint32_t x;
+        uint32_t n;
+        for(x = 0; x < 8; x++) {
+            for(n = 0; n <= 40; n++) {
+                memset(dst, SELFTEST_GUARD, 8);
+                memset(ref, SELFTEST_GUARD, 8);
+                fbdev_pixconv_mono_row(dst, src + 3 * n + 7 * x, x, n, x, flags);
+                mono_row(mono_pack8_portable, ref, src + 3 * n + 7 * x, x, n, x, flags);
+                if(memcmp(dst, ref, 8) != 0) {
+                    fprintf(stderr, "pixconv selftest: 1 bpp %s failed for %u pixels at bit %u\n",
+                            flags ? "dither" : "threshold", n, x);
+                    failed++;
+                    x = 8;
+                    break;
+                }
+            }
+        }
+    }
+
+    free(src);
+    free(dst);
+    free(ref);
+    return failed;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*Scalar reference: one pixel, written byte by byte in memory order*/
+static void ref_pixel(fbdev_pixfmt_t fmt, uint16_t px, uint8_t * out)
+{
+    uint8_t r5 = px >> 11;
+    uint8_t g6 = (px >> 5) & 0x3F;
+    uint8_t b5 = px & 0x1F;
+    uint8_t r = (uint8_t)((r5 << 3) | (r5 >> 2));
+    uint8_t g = (uint8_t)((g6 << 2) | (g6 >> 4));
+    uint8_t b = (uint8_t)((b5 << 3) | (b5 >> 2));
+    uint16_t bgr565 = (uint16_t)((b5 << 11) | (g6 << 5) | r5);
+
+    switch(fmt) {
+        case FBDEV_PIXFMT_RGB565:      out[0] = px & 0xFF; out[1] = px >> 8; break;
+        case FBDEV_PIXFMT_RGB565_SWAP: out[0] = px >> 8; out[1] = px & 0xFF; break;
+        case FBDEV_PIXFMT_BGR565:      out[0] = bgr565 & 0xFF; out[1] = bgr565 >> 8; break;
+        case FBDEV_PIXFMT_XRGB8888:    out[0] = b; out[1] = g; out[2] = r; out[3] = 0xFF; break;
+        case FBDEV_PIXFMT_XBGR8888:    out[0] = r; out[1] = g; out[2] = b; out[3] = 0xFF; break;
+        case FBDEV_PIXFMT_RGB888:      out[0] = b; out[1] = g; out[2] = r; break;
+        case FBDEV_PIXFMT_BGR888:      out[0] = r; out[1] = g; out[2] = b; break;
+        default: break;
+    }
+}
+
+static bool selftest_one(fbdev_pixfmt_t fmt, fbdev_pixconv_impl_t impl, fbdev_pixconv_fn_t fn,
+                         const uint16_t * src, uint8_t * dst, uint8_t * ref)
+{
+    uint32_t bpp = fmt_bytes[fmt];
+    uint32_t i;
+    for(i = 0; i < SELFTEST_PIXELS; i++) ref_pixel(fmt, src[i], &ref[i * bpp]);
+
+    /*Every input value once*/
+    memset(dst, SELFTEST_GUARD, SELFTEST_PIXELS * bpp + 1);
+    fn(dst, src, SELFTEST_PIXELS);
+    if(memcmp(dst, ref, SELFTEST_PIXELS * bpp) != 0 || dst[SELFTEST_PIXELS * bpp] != SELFTEST_GUARD) {
+        fprintf(stderr, "pixconv selftest: %s %s failed on the full range\n", impl_names[impl], fmt_names[fmt]);
+        return false;
+    }
+
+    /*Short runs with misaligned source and destination: exercises every head/tail length*/
+    uint32_t n;
+    uint32_t ofs;
+    for(n = 0; n <= 40; n++) {
+        for(ofs = 0; ofs < 4; ofs++) {
+            const uint16_t * s = src + 1000 + ofs;
+            uint8_t * d = dst + ofs;
+            memset(dst, SELFTEST_GUARD, n * bpp + ofs + 1);
+            fn(d, s, n);
+            for(i = 0; i < n; i++) ref_pixel(fmt, s[i], &ref[i * bpp]);
+            if(memcmp(d, ref, n * bpp) != 0 || d[n * bpp] != SELFTEST_GUARD ||
+               (ofs && dst[ofs - 1] != SELFTEST_GUARD)) {
+                fprintf(stderr, "pixconv selftest: %s %s failed for %u pixels at offset %u\n",
+                        impl_names[impl], fmt_names[fmt], n, ofs);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#endif /*USE_FBDEV || USE_BSD_FBDEV*/
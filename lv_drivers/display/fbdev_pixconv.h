@@ -0,0 +1,130 @@
+/**
+ * @file fbdev_pixconv.h
+ * Row converters from LVGL's RGB565 buffers to the framebuffer's pixel format
+ */
+
+#ifndef FBDEV_PIXCONV_H
+#define FBDEV_PIXCONV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#ifndef LV_DRV_NO_CONF
+#ifdef LV_CONF_INCLUDE_SIMPLE
+#include "lv_drv_conf.h"
+#else
+#include "../../lv_drv_conf.h"
+#endif
+#endif
+
+#if USE_FBDEV || USE_BSD_FBDEV
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+/*fbdev_pixconv_mono_row() flags*/
+#define FBDEV_MONO_DITHER       0x01    /*4x4 ordered dithering instead of a 50% threshold*/
+#define FBDEV_MONO_INVERT       0x02    /*Set bits are black (FB_VISUAL_MONO01)*/
+#define FBDEV_MONO_MSB_FIRST    0x04    /*Leftmost pixel in the most significant bit*/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    FBDEV_PIXFMT_RGB565,        /*Same as the source: plain copy*/
+    FBDEV_PIXFMT_RGB565_SWAP,   /*RGB565 with the two bytes swapped*/
+    FBDEV_PIXFMT_BGR565,        /*Red and blue fields exchanged*/
+    FBDEV_PIXFMT_XRGB8888,      /*32 bpp, red at bit 16 (bytes B, G, R, X in memory)*/
+    FBDEV_PIXFMT_XBGR8888,      /*32 bpp, red at bit 0 (bytes R, G, B, X in memory)*/
+    FBDEV_PIXFMT_RGB888,        /*24 bpp, red at bit 16 (bytes B, G, R in memory)*/
+    FBDEV_PIXFMT_BGR888,        /*24 bpp, red at bit 0 (bytes R, G, B in memory)*/
+    FBDEV_PIXFMT_CNT
+} fbdev_pixfmt_t;
+
+typedef enum {
+    FBDEV_PIXCONV_PORTABLE,
+    FBDEV_PIXCONV_NEON,
+    FBDEV_PIXCONV_SSE2,
+    FBDEV_PIXCONV_IMPL_CNT
+} fbdev_pixconv_impl_t;
+
+/**
+ * Convert one row of `n` RGB565 pixels. `dst` and `src` need no particular alignment.
+ */
+typedef void (*fbdev_pixconv_fn_t)(void * dst, const uint16_t * src, uint32_t n);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Fastest implementation built into this binary for a format
+ */
+fbdev_pixconv_impl_t fbdev_pixconv_best(fbdev_pixfmt_t fmt);
+
+/**
+ * Get the fastest converter built into this binary for a format
+ * @param fmt destination format
+ */
+fbdev_pixconv_fn_t fbdev_pixconv_get(fbdev_pixfmt_t fmt);
+
+/**
+ * Get the converter of one implementation
+ * @return NULL if the implementation is not built in for this target
+ */
+fbdev_pixconv_fn_t fbdev_pixconv_get_impl(fbdev_pixfmt_t fmt, fbdev_pixconv_impl_t impl);
+
+/**
+ * Pick the destination format from the framebuffer's depth and red/blue bit offsets
+ * @return FBDEV_PIXFMT_CNT if there is no converter for it
+ */
+fbdev_pixfmt_t fbdev_pixconv_select(uint32_t bits_per_pixel, uint32_t red_offset, uint32_t blue_offset, bool swapped);
+
+uint32_t fbdev_pixfmt_bytes(fbdev_pixfmt_t fmt);
+const char * fbdev_pixfmt_name(fbdev_pixfmt_t fmt);
+const char * fbdev_pixconv_impl_name(fbdev_pixconv_impl_t impl);
+
+/**
+ * Nearest-neighbour horizontal upscale of one RGB565 row: each pixel is written `factor` times.
+ * 2x and 3x use the vector kernels when available.
+ * @param dst room for n * factor pixels
+ */
+void fbdev_pixconv_upscale_row(uint16_t * dst, const uint16_t * src, uint32_t n, uint32_t factor);
+
+/**
+ * Pack one row of RGB565 pixels into a 1 bpp framebuffer row by luminance.
+ * Whole bytes are built 8 pixels at a time and stored without reading the framebuffer;
+ * only a partial byte at either end is read-modify-written.
+ * @param dst first byte of the framebuffer row
+ * @param x screen column of the first pixel (its bit position from `dst`)
+ * @param n number of pixels
+ * @param y screen row, selects the dither pattern row
+ * @param flags FBDEV_MONO_... flags
+ */
+void fbdev_pixconv_mono_row(uint8_t * dst, const uint16_t * src, uint32_t x, uint32_t n, uint32_t y, uint32_t flags);
+
+/**
+ * Check every built-in converter against a scalar reference, for all 65536 input values
+ * and odd lengths / misaligned pointers. Mismatches are printed to stderr.
+ * @return number of failing converters, 0 on success
+ */
+int fbdev_pixconv_selftest(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif  /*USE_FBDEV || USE_BSD_FBDEV*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*FBDEV_PIXCONV_H*/
@@ -0,0 +1,279 @@
+/**
+ * @file fbdev_rotate.c
+ * Rotation of flushed areas for panels mounted at 90/180/270 degrees
+ *
+ * A naive 90 degree rotation reads along source rows and writes down destination columns, so
+ * every written pixel touches a different cache line. Working in square tiles keeps the tile's
+ * source lines in cache while each destination row of the tile is written sequentially.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "fbdev_rotate.h"
+#if USE_FBDEV || USE_BSD_FBDEV
+
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ROTATE_HAVE_NEON 1
+#else
+#define ROTATE_HAVE_NEON 0
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ROTATE_HAVE_SSE2 1
+#else
+#define ROTATE_HAVE_SSE2 0
+#endif
+
+#define ROTATE_HAVE_SIMD (ROTATE_HAVE_NEON || ROTATE_HAVE_SSE2)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+/**********************
+ *   ROTATE KERNELS
+ **********************/
+/*
+ * One set of kernels per pixel size, working on the source columns [xs, xe) and rows [ys, ye).
+ * In the destination (rows without padding):
+ *  90:  source pixel (x, y) goes to (h - 1 - y, x)
+ *  180: source pixel (x, y) goes to (w - 1 - x, h - 1 - y)
+ *  270: source pixel (x, y) goes to (y, w - 1 - x)
+ */
+#define ROTATE_KERNELS(name, type)                                                              \
+    static void rotate90_##name(type * dst, const type * src, uint32_t w, uint32_t h,           \
+                                uint32_t stride, uint32_t xs, uint32_t xe, uint32_t ys, uint32_t ye) \
+    {                                                                                           \
+        uint32_t x0, y0, x, y;                                                                  \
+        for(y0 = ys; y0 < ye; y0 += FBDEV_ROTATE_TILE) {                                        \
+            uint32_t y1 = y0 + FBDEV_ROTATE_TILE < ye ? y0 + FBDEV_ROTATE_TILE : ye;            \
+            for(x0 = xs; x0 < xe; x0 += FBDEV_ROTATE_TILE) {                                    \
+                uint32_t x1 = x0 + FBDEV_ROTATE_TILE < xe ? x0 + FBDEV_ROTATE_TILE : xe;        \
+                for(x = x0; x < x1; x++) {                                                      \
+                    type * d = dst + x * h + (h - 1 - y0);                                      \
+                    const type * s = src + y0 * stride + x;                                     \
+                    for(y = y0; y < y1; y++) {                                                  \
+                        *d-- = *s;                                                              \
+                        s += stride;                                                            \
+                    }                                                                           \
+                }                                                                               \
+            }                                                                                   \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    static void rotate270_##name(type * dst, const type * src, uint32_t w, uint32_t h,          \
+                                 uint32_t stride, uint32_t xs, uint32_t xe, uint32_t ys, uint32_t ye) \
+    {                                                                                           \
+        uint32_t x0, y0, x, y;                                                                  \
+        for(y0 = ys; y0 < ye; y0 += FBDEV_ROTATE_TILE) {                                        \
+            uint32_t y1 = y0 + FBDEV_ROTATE_TILE < ye ? y0 + FBDEV_ROTATE_TILE : ye;            \
+            for(x0 = xs; x0 < xe; x0 += FBDEV_ROTATE_TILE) {                                    \
+                uint32_t x1 = x0 + FBDEV_ROTATE_TILE < xe ? x0 + FBDEV_ROTATE_TILE : xe;        \
+                for(x = x0; x < x1; x++) {                                                      \
+                    type * d = dst + (w - 1 - x) * h + y0;                                      \
+                    const type * s = src + y0 * stride + x;                                     \
+                    for(y = y0; y < y1; y++) {                                                  \
+                        *d++ = *s;                                                              \
+                        s += stride;                                                            \
+                    }                                                                           \
+                }                                                                               \
+            }                                                                                   \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    static void rotate180_##name(type * dst, const type * src, uint32_t w, uint32_t h,          \
+                                 uint32_t stride)                                               \
+    {                                                                                           \
+        uint32_t x, y;                                                                          \
+        for(y = 0; y < h; y++) {                                                                \
+            type * d = dst + (h - 1 - y) * w + (w - 1);                                         \
+            const type * s = src + y * stride;                                                  \
+            for(x = 0; x < w; x++) *d-- = s[x];                                                 \
+        }                                                                                       \
+    }
+
+ROTATE_KERNELS(8, uint8_t)
+ROTATE_KERNELS(16, uint16_t)
+ROTATE_KERNELS(32, uint32_t)
+
+/**********************
+ *    SIMD KERNELS
+ **********************/
+/*
+ * 16 bit 90/270: 8x8 blocks are transposed in registers, so every load and store is a full
+ * 16 byte row. For 90 degrees the rows are loaded bottom up, which reverses the transposed rows.
+ * Blocks are visited tile by tile like the scalar kernels; the ragged right and bottom edges
+ * are left to the scalar kernels.
+ */
+#if ROTATE_HAVE_NEON
+typedef uint16x8_t vec16_t;
+#define VEC16_LOAD(p)     vld1q_u16(p)
+#define VEC16_STORE(p, v) vst1q_u16(p, v)
+
+static inline void transpose8x8_16(vec16_t r[8])
+{
+    uint16x8x2_t t0 = vtrnq_u16(r[0], r[1]);
+    uint16x8x2_t t1 = vtrnq_u16(r[2], r[3]);
+    uint16x8x2_t t2 = vtrnq_u16(r[4], r[5]);
+    uint16x8x2_t t3 = vtrnq_u16(r[6], r[7]);
+    uint32x4x2_t u0 = vtrnq_u32(vreinterpretq_u32_u16(t0.val[0]), vreinterpretq_u32_u16(t1.val[0]));
+    uint32x4x2_t u1 = vtrnq_u32(vreinterpretq_u32_u16(t0.val[1]), vreinterpretq_u32_u16(t1.val[1]));
+    uint32x4x2_t u2 = vtrnq_u32(vreinterpretq_u32_u16(t2.val[0]), vreinterpretq_u32_u16(t3.val[0]));
+    uint32x4x2_t u3 = vtrnq_u32(vreinterpretq_u32_u16(t2.val[1]), vreinterpretq_u32_u16(t3.val[1]));
+    r[0] = vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u0.val[0]), vget_low_u32(u2.val[0])));
+    r[1] = vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u1.val[0]), vget_low_u32(u3.val[0])));
+    r[2] = vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u0.val[1]), vget_low_u32(u2.val[1])));
+    r[3] = vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u1.val[1]), vget_low_u32(u3.val[1])));
+    r[4] = vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u0.val[0]), vget_high_u32(u2.val[0])));
+    r[5] = vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u1.val[0]), vget_high_u32(u3.val[0])));
+    r[6] = vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u0.val[1]), vget_high_u32(u2.val[1])));
+    r[7] = vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u1.val[1]), vget_high_u32(u3.val[1])));
+}
+#elif ROTATE_HAVE_SSE2
+typedef __m128i vec16_t;
+#define VEC16_LOAD(p)     _mm_loadu_si128((const __m128i *)(p))
+#define VEC16_STORE(p, v) _mm_storeu_si128((__m128i *)(p), v)
+
+static inline void transpose8x8_16(vec16_t r[8])
+{
+    __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+    __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+    __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+    __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+    __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+    __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+    __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+    __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+    r[0] = _mm_unpacklo_epi64(b0, b4);
+    r[1] = _mm_unpackhi_epi64(b0, b4);
+    r[2] = _mm_unpacklo_epi64(b1, b5);
+    r[3] = _mm_unpackhi_epi64(b1, b5);
+    r[4] = _mm_unpacklo_epi64(b2, b6);
+    r[5] = _mm_unpackhi_epi64(b2, b6);
+    r[6] = _mm_unpacklo_epi64(b3, b7);
+    r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+#endif
+
+#if ROTATE_HAVE_SIMD
+static void rotate_simd_16(uint16_t * dst, const uint16_t * src, uint32_t w, uint32_t h, uint32_t stride,
+                           fbdev_rotation_t rot)
+{
+    uint32_t bw = w & ~7U;
+    uint32_t bh = h & ~7U;
+    uint32_t x0, y0, x, y;
+    int i;
+    vec16_t r[8];
+
+    for(y0 = 0; y0 < bh; y0 += FBDEV_ROTATE_TILE) {
+        uint32_t y1 = y0 + FBDEV_ROTATE_TILE < bh ? y0 + FBDEV_ROTATE_TILE : bh;
+        for(x0 = 0; x0 < bw; x0 += FBDEV_ROTATE_TILE) {
+            uint32_t x1 = x0 + FBDEV_ROTATE_TILE < bw ? x0 + FBDEV_ROTATE_TILE : bw;
+            for(y = y0; y < y1; y += 8) {
+                for(x = x0; x < x1; x += 8) {
+                    const uint16_t * s = src + y * stride + x;
+                    if(rot == FBDEV_ROT_90) {
+                        for(i = 0; i < 8; i++) r[i] = VEC16_LOAD(s + (7 - i) * stride);
+                        transpose8x8_16(r);
+                        uint16_t * d = dst + x * h + (h - 8 - y);
+                        for(i = 0; i < 8; i++) VEC16_STORE(d + i * h, r[i]);
+                    }
+                    else {
+                        for(i = 0; i < 8; i++) r[i] = VEC16_LOAD(s + i * stride);
+                        transpose8x8_16(r);
+                        uint16_t * d = dst + (w - 1 - x) * h + y;
+                        for(i = 0; i < 8; i++) VEC16_STORE(d - i * h, r[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    /*Right columns (all rows), then the bottom rows under the blocks*/
+    if(rot == FBDEV_ROT_90) {
+        rotate90_16(dst, src, w, h, stride, bw, w, 0, h);
+        rotate90_16(dst, src, w, h, stride, 0, bw, bh, h);
+    }
+    else {
+        rotate270_16(dst, src, w, h, stride, bw, w, 0, h);
+        rotate270_16(dst, src, w, h, stride, 0, bw, bh, h);
+    }
+}
+#endif
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void fbdev_rotate(void * dst, const void * src, uint32_t w, uint32_t h, uint32_t src_stride,
+                  uint32_t px_bytes, fbdev_rotation_t rot)
+{
+    if(rot == FBDEV_ROT_0) {
+        uint32_t y;
+        for(y = 0; y < h; y++) {
+            memcpy((uint8_t *)dst + y * w * px_bytes, (const uint8_t *)src + y * src_stride * px_bytes, w * px_bytes);
+        }
+        return;
+    }
+
+    switch(px_bytes) {
+        case 1:
+            if(rot == FBDEV_ROT_90) rotate90_8(dst, src, w, h, src_stride, 0, w, 0, h);
+            else if(rot == FBDEV_ROT_180) rotate180_8(dst, src, w, h, src_stride);
+            else rotate270_8(dst, src, w, h, src_stride, 0, w, 0, h);
+            break;
+        case 2:
+            if(rot == FBDEV_ROT_180) rotate180_16(dst, src, w, h, src_stride);
+#if ROTATE_HAVE_SIMD
+            else rotate_simd_16(dst, src, w, h, src_stride, rot);
+#else
+            else if(rot == FBDEV_ROT_90) rotate90_16(dst, src, w, h, src_stride, 0, w, 0, h);
+            else rotate270_16(dst, src, w, h, src_stride, 0, w, 0, h);
+#endif
+            break;
+        case 4:
+            if(rot == FBDEV_ROT_90) rotate90_32(dst, src, w, h, src_stride, 0, w, 0, h);
+            else if(rot == FBDEV_ROT_180) rotate180_32(dst, src, w, h, src_stride);
+            else rotate270_32(dst, src, w, h, src_stride, 0, w, 0, h);
+            break;
+        default:
+            break;
+    }
+}
+
+fbdev_rotation_t fbdev_rotation_from_degrees(int degrees)
+{
+    switch(degrees) {
+        case 90:
+            return FBDEV_ROT_90;
+        case 180:
+            return FBDEV_ROT_180;
+        case 270:
+            return FBDEV_ROT_270;
+        default:
+            return FBDEV_ROT_0;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#endif /*USE_FBDEV || USE_BSD_FBDEV*/
@@ -0,0 +1,82 @@
+/**
+ * @file fbdev_rotate.h
+ * Rotation of flushed areas for panels mounted at 90/180/270 degrees
+ */
+
+#ifndef FBDEV_ROTATE_H
+#define FBDEV_ROTATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#ifndef LV_DRV_NO_CONF
+#ifdef LV_CONF_INCLUDE_SIMPLE
+#include "lv_drv_conf.h"
+#else
+#include "../../lv_drv_conf.h"
+#endif
+#endif
+
+#if USE_FBDEV || USE_BSD_FBDEV
+
+#include <stdint.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Side of the square tiles of the 90/270 degree transpose, in pixels*/
+#ifndef FBDEV_ROTATE_TILE
+#define FBDEV_ROTATE_TILE 16
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*Clockwise rotation of the picture on the panel*/
+typedef enum {
+    FBDEV_ROT_0,
+    FBDEV_ROT_90,
+    FBDEV_ROT_180,
+    FBDEV_ROT_270,
+} fbdev_rotation_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Rotate a `w` x `h` block of pixels clockwise into a packed buffer.
+ * 90 and 270 degrees are done as a transpose in FBDEV_ROTATE_TILE sized tiles, so both the
+ * source rows and the destination rows of a tile stay in cache.
+ * @param dst receives h x w pixels (90/270) or w x h pixels (0/180), rows without padding
+ * @param src first pixel of the block
+ * @param w width of the block in pixels
+ * @param h height of the block in pixels
+ * @param src_stride distance between source rows in pixels
+ * @param px_bytes size of a pixel: 1, 2 or 4
+ * @param rot rotation
+ */
+void fbdev_rotate(void * dst, const void * src, uint32_t w, uint32_t h, uint32_t src_stride,
+                  uint32_t px_bytes, fbdev_rotation_t rot);
+
+/**
+ * @param degrees 0, 90, 180 or 270
+ * @return the rotation or FBDEV_ROT_0 for other values
+ */
+fbdev_rotation_t fbdev_rotation_from_degrees(int degrees);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif  /*USE_FBDEV || USE_BSD_FBDEV*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*FBDEV_ROTATE_H*/
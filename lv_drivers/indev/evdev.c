@@ -118,6 +118,64 @@ bool evdev_set_file(char* dev_name)
 
      return true;
 }
+/**
+ * Translate an evdev key code into an LVGL key
+ * @param code EV_KEY code from the input_event
+ * @param pressed true for key down / repeat, false for key up
+ * @return the LV_KEY_* value or character, 0 if the key is not mapped
+ */
+uint32_t evdev_key_to_lv(uint16_t code, bool pressed)
+{
+#if USE_XKB
+    return xkb_process_key(code, pressed);
+#else
+    (void)pressed;
+    switch(code) {
+        case KEY_BACKSPACE:
+            return LV_KEY_BACKSPACE;
+        case KEY_ENTER:
+            return LV_KEY_ENTER;
+        case KEY_PREVIOUS:
+            return LV_KEY_PREV;
+        case KEY_NEXT:
+            return LV_KEY_NEXT;
+        case KEY_UP:
+            return LV_KEY_UP;
+        case KEY_LEFT:
+            return LV_KEY_LEFT;
+        case KEY_RIGHT:
+            return LV_KEY_RIGHT;
+        case KEY_DOWN:
+            return LV_KEY_DOWN;
+        case KEY_TAB:
+            return LV_KEY_NEXT;
+        // Addition
+        // Keypad translate
+        case KEY_A:
+            return LV_KEY_DOWN;
+        case KEY_W:
+            return LV_KEY_PREV;
+        case KEY_S:
+            return LV_KEY_NEXT;
+        case KEY_D:
+            return LV_KEY_UP;
+        case KEY_SPACE:
+            return LV_KEY_ENTER;
+        // Modify end
+
+        default:
+            return 0;
+    }
+#endif /* USE_XKB */
+}
+/**
+ * Get the file descriptor of the opened evdev device
+ * @return the fd, or -1 if no device is open
+ */
+int evdev_get_fd(void)
+{
+    return evdev_fd;
+}
 /**
  * Get the current position and state of the evdev
  * @param data store the evdev data here
@@ -177,61 +235,7 @@ void evdev_read(lv_indev_drv_t * drv, lv_indev_data_t * data)
                 else if(in.value == 1)
                     evdev_button = LV_INDEV_STATE_PR;
             } else if(drv->type == LV_INDEV_TYPE_KEYPAD) {
-#if USE_XKB
-                data->key = xkb_process_key(in.code, in.value != 0);
-#else
-                switch(in.code) {
-                    case KEY_BACKSPACE:
-                        data->key = LV_KEY_BACKSPACE;
-                        break;
-                    case KEY_ENTER:
-                        data->key = LV_KEY_ENTER;
-                        break;
-                    case KEY_PREVIOUS:
-                        data->key = LV_KEY_PREV;
-                        break;
-                    case KEY_NEXT:
-                        data->key = LV_KEY_NEXT;
-                        break;
-                    case KEY_UP:
-                        data->key = LV_KEY_UP;
-                        break;
-                    case KEY_LEFT:
-                        data->key = LV_KEY_LEFT;
-                        break;
-                    case KEY_RIGHT:
-                        data->key = LV_KEY_RIGHT;
-                        break;
-                    case KEY_DOWN:
-                        data->key = LV_KEY_DOWN;
-                        break;
-                    case KEY_TAB:
-                        data->key = LV_KEY_NEXT;
-                        break;
-                    // Addition
-                    // Keypad translate
-                    case KEY_A:
-                        data->key = LV_KEY_DOWN;
-                        break;
-                    case KEY_W:
-                        data->key = LV_KEY_PREV;
-                        break;
-                    case KEY_S:
-                        data->key = LV_KEY_NEXT;
-                        break;
-                    case KEY_D:
-                        data->key = LV_KEY_UP;
-                        break;    
-                    case KEY_SPACE:
-                        data->key = LV_KEY_ENTER;
-                        break;
-                    // Modify end
-                        
-                    default:
-                        data->key = 0;
-                        break;
-                }
-#endif /* USE_XKB */
+                data->key = evdev_key_to_lv(in.code, in.value != 0);
                 if (data->key != 0) {
                     /* Only record button state when actual output is produced to prevent widgets from refreshing */
                     data->state = (in.value) ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
@@ -52,6 +52,18 @@ void evdev_init(void);
  *         false: the device file doesn't exist current system
  */
 bool evdev_set_file(char* dev_name);
+/**
+ * Translate an evdev key code into an LVGL key
+ * @param code EV_KEY code from the input_event
+ * @param pressed true for key down / repeat, false for key up
+ * @return the LV_KEY_* value or character, 0 if the key is not mapped
+ */
+uint32_t evdev_key_to_lv(uint16_t code, bool pressed);
+/**
+ * Get the file descriptor of the opened evdev device
+ * @return the fd, or -1 if no device is open
+ */
+int evdev_get_fd(void);
 /**
  * Get the current position and state of the evdev
  * @param data store the evdev data here
@@ -0,0 +1,93 @@
+/**
+ * @file area_coalesce.c
+ * @brief Merges a frame's invalidated areas before LVGL renders and flushes them.
+ */
+
+#include "area_coalesce.h"
+
+static area_coalesce_stats_t stats;
+static lv_disp_t * coalesce_disp;
+static uint32_t call_cost;
+
+// --- Cost Model ---
+// Drawing an area costs its pixels plus call_cost_px; merging pays off when the bounding box
+// costs less than both areas drawn separately (an overlap is drawn twice then).
+static int64_t merge_saving(const lv_area_t * a, const lv_area_t * b, uint32_t call_cost_px) {
+    lv_area_t box;
+    box.x1 = LV_MIN(a->x1, b->x1);
+    box.y1 = LV_MIN(a->y1, b->y1);
+    box.x2 = LV_MAX(a->x2, b->x2);
+    box.y2 = LV_MAX(a->y2, b->y2);
+    return (int64_t)call_cost_px + lv_area_get_size(a) + lv_area_get_size(b) - lv_area_get_size(&box);
+}
+
+uint32_t area_coalesce_merge(lv_area_t * areas, uint32_t cnt, uint32_t call_cost_px) {
+    // Greedy: merge the most profitable pair until no pair gains anything.
+    // A merged box may now overlap a third area, so every round rescans all pairs.
+    while (cnt > 1) {
+        int64_t best = 0;
+        uint32_t best_i = 0, best_j = 0;
+        for (uint32_t i = 0; i < cnt; i++) {
+            for (uint32_t j = i + 1; j < cnt; j++) {
+                int64_t s = merge_saving(&areas[i], &areas[j], call_cost_px);
+                if (s > best) {
+                    best = s;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        if (best <= 0) break;
+        _lv_area_join(&areas[best_i], &areas[best_i], &areas[best_j]);
+        areas[best_j] = areas[--cnt];
+    }
+    return cnt;
+}
+
+// --- Refresh Hook ---
+static void coalesce_refr_timer_cb(lv_timer_t * timer) {
+    lv_disp_t * disp = coalesce_disp;
+    if (disp->inv_p) {
+        // Drop areas LVGL already marked as joined (none at the start of a refresh, normally)
+        uint32_t in = 0;
+        uint64_t px_in = 0;
+        for (uint32_t i = 0; i < disp->inv_p; i++) {
+            if (disp->inv_area_joined[i]) continue;
+            disp->inv_areas[in++] = disp->inv_areas[i];
+            px_in += lv_area_get_size(&disp->inv_areas[i]);
+        }
+        uint32_t out = area_coalesce_merge(disp->inv_areas, in, call_cost);
+        lv_memset_00(disp->inv_area_joined, sizeof(disp->inv_area_joined));
+        disp->inv_p = out;
+
+        stats.frames++;
+        stats.areas_in += in;
+        stats.areas_out += out;
+        stats.px_in += px_in;
+        for (uint32_t i = 0; i < out; i++) stats.px_out += lv_area_get_size(&disp->inv_areas[i]);
+        stats.last_areas_in = in;
+        stats.last_areas_out = out;
+        if (in > stats.max_areas_in) stats.max_areas_in = in;
+    }
+    _lv_disp_refr_timer(timer);
+}
+
+void area_coalesce_init(lv_disp_t * disp, uint32_t call_cost_px) {
+    if (!disp || !call_cost_px) return;
+    coalesce_disp = disp;
+    call_cost = call_cost_px;
+    lv_timer_set_cb(_lv_disp_get_refr_timer(disp), coalesce_refr_timer_cb);
+}
+
+void area_coalesce_get_stats(area_coalesce_stats_t * out) {
+    *out = stats;
+}
+
+void area_coalesce_dump_stats(FILE * out) {
+    if (!coalesce_disp) return;
+    fprintf(out, "[coalesce] %llu frames, %llu areas in -> %llu out (last frame %u -> %u, max %u in), "
+                 "%llu -> %llu px, call cost %u px\n",
+            (unsigned long long)stats.frames, (unsigned long long)stats.areas_in,
+            (unsigned long long)stats.areas_out, stats.last_areas_in, stats.last_areas_out,
+            stats.max_areas_in, (unsigned long long)stats.px_in, (unsigned long long)stats.px_out, call_cost);
+}
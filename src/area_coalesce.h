@@ -0,0 +1,50 @@
+/**
+ * @file area_coalesce.h
+ * @brief Merges a frame's invalidated areas before LVGL renders and flushes them.
+ *
+ * Moving the focus in a list invalidates a few small, often overlapping areas (old button,
+ * new button, scrollbar). LVGL renders and flushes each of them separately, walking the
+ * object tree and running the flush row loop once per area, and only joins areas whose
+ * bounding box is smaller than the two together. Here two areas are merged whenever
+ * drawing their bounding box costs less than drawing both, counting every area as
+ * call_cost_px extra pixels of work.
+ */
+
+#ifndef AREA_COALESCE_H
+#define AREA_COALESCE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "lvgl/lvgl.h"
+
+// Default per-area overhead in pixels: about five 320 pixel rows
+#define AREA_COALESCE_DEFAULT_CALL_COST_PX 1600
+
+typedef struct {
+    uint64_t frames;         // Refreshes with at least one invalidated area
+    uint64_t areas_in;       // Areas LVGL had invalidated
+    uint64_t areas_out;      // Areas left to render after merging
+    uint64_t px_in;          // Sum of the invalidated areas' sizes (overlaps counted twice)
+    uint64_t px_out;         // Sum of the rendered areas' sizes
+    uint32_t last_areas_in;
+    uint32_t last_areas_out;
+    uint32_t max_areas_in;
+} area_coalesce_stats_t;
+
+/**
+ * Merge the display's invalidated areas at the start of every refresh.
+ * @param disp display whose refresh timer is wrapped
+ * @param call_cost_px overhead of one extra area in pixels, 0 = leave the areas alone
+ */
+void area_coalesce_init(lv_disp_t * disp, uint32_t call_cost_px);
+
+/**
+ * Merge a list of areas in place.
+ * @return the new number of areas
+ */
+uint32_t area_coalesce_merge(lv_area_t * areas, uint32_t cnt, uint32_t call_cost_px);
+
+void area_coalesce_get_stats(area_coalesce_stats_t * stats);
+void area_coalesce_dump_stats(FILE * out);
+
+#endif // AREA_COALESCE_H
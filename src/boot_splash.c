@@ -0,0 +1,210 @@
+/**
+ * @file boot_splash.c
+ * @brief Shows a cached copy of the main menu on the framebuffer before LVGL is up.
+ *
+ * The cache file is a small header followed by the visible screen in the framebuffer's
+ * native format. It is keyed by a hash of the executable (size + mtime) and the preferences
+ * file, so a new build or changed settings simply produce a miss and a fresh capture.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "boot_splash.h"
+#include "lv_drivers/display/fbdev.h"
+#include "rt_sched.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SPLASH_MAGIC   0x4C505350u   // "PSPL"
+#define SPLASH_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bpp;
+    uint32_t size;     // Pixel bytes following the header
+} splash_header_t;
+
+static uint64_t start_us;
+static uint64_t cache_key;
+static bool cache_valid;
+static bool frame_seen;
+static boot_splash_stats_t stats;
+
+// --- Helper Functions ---
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static uint64_t fnv1a(uint64_t h, const void * data, size_t len) {
+    const uint8_t * p = data;
+    while (len--) {
+        h ^= *p++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static uint64_t compute_key(const char * config_path) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    struct stat st;
+    if (stat("/proc/self/exe", &st) == 0) {
+        uint64_t v[2] = {(uint64_t)st.st_size, (uint64_t)st.st_mtime};
+        h = fnv1a(h, v, sizeof(v));
+    }
+
+    if (config_path) {
+        FILE * fp = fopen(config_path, "r");
+        if (fp) {
+            char buf[256];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) h = fnv1a(h, buf, n);
+            fclose(fp);
+        }
+    }
+    return h;
+}
+
+static void fill_header(splash_header_t * hdr) {
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = SPLASH_MAGIC;
+    hdr->version = SPLASH_VERSION;
+    hdr->key = cache_key;
+    fbdev_get_sizes(&hdr->width, &hdr->height);
+    hdr->bpp = fbdev_get_bpp();
+    hdr->size = fbdev_get_screen_bytes();
+}
+
+// --- Cache Writer (background thread) ---
+static void * save_thread(void * arg) {
+    uint8_t * file = arg;
+    const splash_header_t * hdr = (const splash_header_t *)file;
+    size_t len = sizeof(*hdr) + hdr->size;
+
+    mkdir(BOOT_SPLASH_DIR, 0755);
+
+    // Write to a temporary file and rename, so a power cut never leaves a torn frame behind
+    const char * tmp = BOOT_SPLASH_FILE ".tmp";
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("boot splash: open");
+        free(file);
+        return NULL;
+    }
+
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(fd, file + done, len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += n;
+    }
+    bool ok = done == len && fsync(fd) == 0;
+    close(fd);
+
+    if (ok && rename(tmp, BOOT_SPLASH_FILE) == 0) {
+        fprintf(stderr, "[splash] cached %u bytes to %s\n", (unsigned)len, BOOT_SPLASH_FILE);
+    } else {
+        perror("boot splash: write");
+        unlink(tmp);
+    }
+    free(file);
+    return NULL;
+}
+
+static void save_cache(void) {
+    splash_header_t hdr;
+    fill_header(&hdr);
+    if (hdr.size == 0) return;
+
+    // Snapshot the framebuffer now; the file I/O happens off the UI thread
+    uint8_t * file = malloc(sizeof(hdr) + hdr.size);
+    if (!file) return;
+    memcpy(file, &hdr, sizeof(hdr));
+    if (!fbdev_read_screen(file + sizeof(hdr))) {
+        free(file);
+        return;
+    }
+
+    pthread_t th;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstacksize(&attr, RT_SCHED_THREAD_STACK_SIZE);
+    if (pthread_create(&th, &attr, save_thread, file) != 0) free(file);
+    else stats.saved = true;
+    pthread_attr_destroy(&attr);
+}
+
+// --- Public API ---
+void boot_splash_mark_start(void) {
+    start_us = now_us();
+}
+
+bool boot_splash_show(const char * config_path) {
+    cache_key = compute_key(config_path);
+
+    splash_header_t want;
+    fill_header(&want);
+    if (want.size == 0) return false;
+
+    int fd = open(BOOT_SPLASH_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    void * map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == sizeof(want) + want.size) {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    // Stale build, other settings or another screen mode: leave the screen alone
+    if (memcmp(map, &want, sizeof(want)) == 0) {
+        cache_valid = fbdev_write_screen((const uint8_t *)map + sizeof(want));
+    }
+    munmap(map, st.st_size);
+
+    if (cache_valid) {
+        stats.shown = true;
+        stats.splash_us = (uint32_t)(now_us() - start_us);
+    }
+    return cache_valid;
+}
+
+void boot_splash_frame_done(uint32_t px, uint32_t screen_px) {
+    if (frame_seen || px < screen_px) return;
+    frame_seen = true;
+
+    stats.live_us = (uint32_t)(now_us() - start_us);
+    boot_splash_dump_stats(stderr);
+
+    if (!cache_valid) save_cache();
+}
+
+void boot_splash_get_stats(boot_splash_stats_t * out) {
+    *out = stats;
+}
+
+void boot_splash_dump_stats(FILE * out) {
+    if (stats.shown) {
+        fprintf(out, "[splash] first pixel %.1f ms (cached frame), first live frame %.1f ms\n",
+                stats.splash_us / 1000.0, stats.live_us / 1000.0);
+    } else {
+        fprintf(out, "[splash] no cached frame, first pixel = first live frame %.1f ms%s\n",
+                stats.live_us / 1000.0, stats.saved ? " (cache saved)" : "");
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * @file boot_splash.h
+ * @brief Shows a cached copy of the main menu on the framebuffer before LVGL is up.
+ */
+
+#ifndef BOOT_SPLASH_H
+#define BOOT_SPLASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifndef BOOT_SPLASH_DIR
+#define BOOT_SPLASH_DIR "/var/cache/pico-menu"
+#endif
+#define BOOT_SPLASH_FILE BOOT_SPLASH_DIR "/splash.raw"
+
+typedef struct {
+    bool shown;          // The cached frame was copied to the framebuffer
+    bool saved;          // A new cache file was written this boot
+    uint32_t splash_us;  // main() to splash on screen, 0 if not shown
+    uint32_t live_us;    // main() to the first fully rendered LVGL frame
+} boot_splash_stats_t;
+
+/**
+ * Take the boot time reference. Call first thing in main().
+ */
+void boot_splash_mark_start(void);
+
+/**
+ * Copy the cached frame to the framebuffer if it matches this binary, config and screen mode.
+ * Call right after fbdev_init(), before lv_init().
+ * @param config_path file whose contents are part of the cache key (the preferences), may be NULL
+ * @return true if the splash is on screen
+ */
+bool boot_splash_show(const char * config_path);
+
+/**
+ * Report a finished refresh (from the display driver's monitor_cb). The first full-screen
+ * frame ends the splash phase; if the cache was missing or stale it is rewritten from the
+ * framebuffer on a background thread.
+ * @param px number of pixels rendered in this refresh
+ * @param screen_px hor_res * ver_res
+ */
+void boot_splash_frame_done(uint32_t px, uint32_t screen_px);
+
+void boot_splash_get_stats(boot_splash_stats_t * stats);
+void boot_splash_dump_stats(FILE * out);
+
+#endif // BOOT_SPLASH_H
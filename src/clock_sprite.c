@@ -0,0 +1,205 @@
+/**
+ * @file clock_sprite.c
+ * @brief Clock widget drawing pre-blended RGB565 glyph sprites instead of going through lv_label.
+ */
+
+#include "clock_sprite.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char sprite_chars[] = "0123456789: APM";
+#define SPRITE_CNT (sizeof(sprite_chars) - 1)
+
+typedef struct {
+    lv_img_dsc_t img[SPRITE_CNT];   // One opaque cell per character
+    lv_color_t * pixels;            // Backing store for all sprites
+    lv_coord_t height;
+
+    char text[CLOCK_SPRITE_MAX_CHARS + 1];
+    uint8_t cell_sprite[CLOCK_SPRITE_MAX_CHARS];   // Index into img[], SPRITE_CNT = none
+    lv_coord_t cell_x[CLOCK_SPRITE_MAX_CHARS];
+    uint8_t cell_cnt;
+} clock_sprite_t;
+
+// --- Rasterization ---
+static int sprite_index(char c) {
+    const char * p = c ? strchr(sprite_chars, c) : NULL;
+    return p ? (int)(p - sprite_chars) : (int)SPRITE_CNT;
+}
+
+// Read one pixel's coverage (0..255) from a continuous LVGL font bitmap
+static uint8_t glyph_alpha(const uint8_t * bmp, uint32_t idx, uint8_t bpp) {
+    uint32_t bit = idx * bpp;
+    uint8_t byte = bmp[bit >> 3];
+    uint8_t v = (byte >> (8 - bpp - (bit & 7))) & ((1 << bpp) - 1);
+    switch (bpp) {
+        case 1: return v ? 255 : 0;
+        case 2: return v * 85;
+        case 4: return v * 17;
+        default: return v;
+    }
+}
+
+static lv_coord_t char_width(const lv_font_t * font, char c) {
+    lv_font_glyph_dsc_t g;
+    if (!lv_font_get_glyph_dsc(font, &g, (uint8_t)c, 0)) return 0;
+    return g.adv_w;
+}
+
+// Digits share one cell width so the clock doesn't jitter when they change
+static lv_coord_t sprite_width(const lv_font_t * font, char c) {
+    if (c >= '0' && c <= '9') {
+        lv_coord_t w = 0;
+        for (char d = '0'; d <= '9'; d++) w = LV_MAX(w, char_width(font, d));
+        return w;
+    }
+    return char_width(font, c);
+}
+
+static void rasterize(clock_sprite_t * cs, const lv_font_t * font, lv_color_t fg, lv_color_t bg) {
+    cs->height = font->line_height;
+
+    size_t total = 0;
+    for (size_t i = 0; i < SPRITE_CNT; i++) total += sprite_width(font, sprite_chars[i]) * cs->height;
+    cs->pixels = malloc(total * sizeof(lv_color_t));
+    if (!cs->pixels) return;
+
+    lv_color_t * dst = cs->pixels;
+    for (size_t i = 0; i < SPRITE_CNT; i++) {
+        char c = sprite_chars[i];
+        lv_coord_t w = sprite_width(font, c);
+        for (lv_coord_t p = 0; p < w * cs->height; p++) dst[p] = bg;
+
+        lv_font_glyph_dsc_t g;
+        const uint8_t * bmp = NULL;
+        if (lv_font_get_glyph_dsc(font, &g, (uint8_t)c, 0) && g.box_w && g.box_h) {
+            bmp = lv_font_get_glyph_bitmap(font, (uint8_t)c);
+        }
+        if (bmp) {
+            // Same placement as LVGL's label drawing; centred in wider digit cells
+            lv_coord_t x0 = g.ofs_x + (w - g.adv_w) / 2;
+            lv_coord_t y0 = (font->line_height - font->base_line) - g.box_h - g.ofs_y;
+            for (lv_coord_t y = 0; y < g.box_h; y++) {
+                lv_coord_t dy = y0 + y;
+                if (dy < 0 || dy >= cs->height) continue;
+                for (lv_coord_t x = 0; x < g.box_w; x++) {
+                    lv_coord_t dx = x0 + x;
+                    if (dx < 0 || dx >= w) continue;
+                    uint8_t a = glyph_alpha(bmp, y * g.box_w + x, g.bpp);
+                    if (a) dst[dy * w + dx] = lv_color_mix(fg, bg, a);
+                }
+            }
+        }
+
+        lv_img_dsc_t * img = &cs->img[i];
+        memset(img, 0, sizeof(*img));
+        img->header.cf = LV_IMG_CF_TRUE_COLOR;
+        img->header.w = w;
+        img->header.h = cs->height;
+        img->data_size = w * cs->height * sizeof(lv_color_t);
+        img->data = (const uint8_t *)dst;
+        dst += w * cs->height;
+    }
+}
+
+static lv_coord_t cell_width(const clock_sprite_t * cs, uint8_t sprite) {
+    return sprite < SPRITE_CNT ? cs->img[sprite].header.w : 0;
+}
+
+// Same character count and every changed cell keeps its width ("12:59" -> "13:00", not "AM" -> "PM")
+static bool same_layout(const clock_sprite_t * cs, const char * text, uint8_t len) {
+    if (len != cs->cell_cnt) return false;
+    for (uint8_t i = 0; i < len; i++) {
+        if (cs->text[i] != text[i] &&
+            cell_width(cs, cs->cell_sprite[i]) != cell_width(cs, sprite_index(text[i]))) return false;
+    }
+    return true;
+}
+
+// --- Widget ---
+static void clock_sprite_event_cb(lv_event_t * e) {
+    lv_obj_t * obj = lv_event_get_target(e);
+    clock_sprite_t * cs = lv_obj_get_user_data(obj);
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_DELETE) {
+        if (cs) {
+            free(cs->pixels);
+            free(cs);
+        }
+        return;
+    }
+    if (code != LV_EVENT_DRAW_MAIN || !cs || !cs->pixels) return;
+
+    lv_draw_ctx_t * draw_ctx = lv_event_get_draw_ctx(e);
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+
+    lv_draw_img_dsc_t dsc;
+    lv_draw_img_dsc_init(&dsc);
+
+    for (uint8_t i = 0; i < cs->cell_cnt; i++) {
+        if (cs->cell_sprite[i] >= SPRITE_CNT) continue;
+        const lv_img_dsc_t * img = &cs->img[cs->cell_sprite[i]];
+        lv_area_t a;
+        a.x1 = coords.x1 + cs->cell_x[i];
+        a.y1 = coords.y1;
+        a.x2 = a.x1 + img->header.w - 1;
+        a.y2 = a.y1 + img->header.h - 1;
+        lv_area_t clipped;
+        if (_lv_area_intersect(&clipped, &a, draw_ctx->clip_area)) lv_draw_img(draw_ctx, &dsc, &a, img);
+    }
+}
+
+lv_obj_t * clock_sprite_create(lv_obj_t * parent, const lv_font_t * font, lv_color_t fg, lv_color_t bg) {
+    lv_obj_t * obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+
+    clock_sprite_t * cs = calloc(1, sizeof(clock_sprite_t));
+    if (cs) rasterize(cs, font, fg, bg);
+    lv_obj_set_user_data(obj, cs);
+    lv_obj_add_event_cb(obj, clock_sprite_event_cb, LV_EVENT_ALL, NULL);
+    lv_obj_set_size(obj, 0, cs ? cs->height : 0);
+    return obj;
+}
+
+void clock_sprite_set_text(lv_obj_t * obj, const char * text) {
+    clock_sprite_t * cs = lv_obj_get_user_data(obj);
+    if (!cs || !cs->pixels) return;
+
+    size_t text_len = strlen(text);
+    uint8_t len = text_len > CLOCK_SPRITE_MAX_CHARS ? CLOCK_SPRITE_MAX_CHARS : (uint8_t)text_len;
+
+    // Layout unchanged: redraw only the cells that differ
+    if (same_layout(cs, text, len)) {
+        lv_area_t coords;
+        lv_obj_get_coords(obj, &coords);
+        for (uint8_t i = 0; i < len; i++) {
+            if (cs->text[i] == text[i]) continue;
+            cs->text[i] = text[i];
+            cs->cell_sprite[i] = sprite_index(text[i]);
+
+            lv_area_t a;
+            a.x1 = coords.x1 + cs->cell_x[i];
+            a.x2 = (i + 1 < len ? coords.x1 + cs->cell_x[i + 1] : coords.x2 + 1) - 1;
+            a.y1 = coords.y1;
+            a.y2 = coords.y2;
+            lv_obj_invalidate_area(obj, &a);
+        }
+        return;
+    }
+
+    // New layout (24h -> 12h, AM -> PM): place the cells and redraw everything
+    lv_coord_t x = 0;
+    for (uint8_t i = 0; i < len; i++) {
+        cs->text[i] = text[i];
+        cs->cell_sprite[i] = sprite_index(text[i]);
+        cs->cell_x[i] = x;
+        x += cell_width(cs, cs->cell_sprite[i]);
+    }
+    cs->text[len] = '\0';
+    cs->cell_cnt = len;
+    lv_obj_set_width(obj, x);
+    lv_obj_invalidate(obj);
+}
@@ -0,0 +1,33 @@
+/**
+ * @file clock_sprite.h
+ * @brief Clock widget drawing pre-blended RGB565 glyph sprites instead of going through lv_label.
+ *
+ * The glyphs a clock can show ("0-9", ":", " ", "AM/PM") are blended against the known
+ * background once at creation. Updating the text only invalidates the cells that changed,
+ * and drawing a cell is an opaque true-colour image copy.
+ */
+
+#ifndef CLOCK_SPRITE_H
+#define CLOCK_SPRITE_H
+
+#include "lvgl/lvgl.h"
+
+// Longest text the widget can show ("12:34:56 PM")
+#define CLOCK_SPRITE_MAX_CHARS 11
+
+/**
+ * Create the clock widget.
+ * @param parent parent object
+ * @param font font the sprites are rasterized from
+ * @param fg text colour
+ * @param bg colour of whatever is behind the widget; the sprites are opaque
+ */
+lv_obj_t * clock_sprite_create(lv_obj_t * parent, const lv_font_t * font, lv_color_t fg, lv_color_t bg);
+
+/**
+ * Show a new text. Only cells whose character changed are redrawn.
+ * Characters without a sprite are shown as blanks.
+ */
+void clock_sprite_set_text(lv_obj_t * obj, const char * text);
+
+#endif // CLOCK_SPRITE_H
@@ -0,0 +1,209 @@
+/**
+ * @file event_loop.c
+ * @brief epoll based main loop: blocks until an fd is readable or the next LVGL timer is due.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "event_loop.h"
+#include "tick.h"
+#include "frame_sched.h"
+#include "watchdog.h"
+#include "startup.h"
+#include "lvgl/lvgl.h"
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/timerfd.h>
+
+#ifndef LV_NO_TIMER_READY
+#define LV_NO_TIMER_READY 0xFFFFFFFF
+#endif
+
+typedef struct {
+    int fd;
+    event_loop_fd_cb_t cb;
+    void * user_data;
+} event_loop_source_t;
+
+static int epoll_fd = -1;
+static int deadline_fd = -1;
+static uint64_t deadline_ns; // Absolute CLOCK_MONOTONIC time the timerfd is armed for, 0 if disarmed
+static event_loop_source_t sources[EVENT_LOOP_MAX_FDS];
+static event_loop_stats_t stats;
+
+// Reference points for event_loop_dump_stats()
+static uint64_t start_cpu_ns;
+static uint64_t start_wall_ns;
+static event_loop_stats_t last_dump;
+
+// --- Helper Functions ---
+static uint64_t clock_ns(clockid_t clk) {
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static event_loop_source_t * find_source(int fd) {
+    for (int i = 0; i < EVENT_LOOP_MAX_FDS; i++) {
+        if (sources[i].cb && sources[i].fd == fd) return &sources[i];
+    }
+    return NULL;
+}
+
+// Arm the timerfd for `ms` from now. LV_NO_TIMER_READY disarms it.
+static void arm_deadline(uint32_t ms) {
+    struct itimerspec its = {0};
+    deadline_ns = 0;
+    if (ms != LV_NO_TIMER_READY) {
+        deadline_ns = clock_ns(CLOCK_MONOTONIC) + (uint64_t)ms * 1000000ULL;
+        its.it_value.tv_sec = deadline_ns / 1000000000ULL;
+        its.it_value.tv_nsec = deadline_ns % 1000000000ULL;
+    }
+    timerfd_settime(deadline_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+// --- Public API ---
+bool event_loop_init(void) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        return false;
+    }
+
+    deadline_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (deadline_fd < 0) {
+        perror("timerfd_create");
+        return false;
+    }
+
+    struct epoll_event ev = {0};
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // NULL marks the deadline timer
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, deadline_fd, &ev) < 0) {
+        perror("epoll_ctl(timerfd)");
+        return false;
+    }
+
+    start_cpu_ns = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+    start_wall_ns = clock_ns(CLOCK_MONOTONIC);
+    return true;
+}
+
+bool event_loop_add_fd(int fd, uint32_t events, event_loop_fd_cb_t cb, void * user_data) {
+    if (fd < 0 || !cb || find_source(fd)) return false;
+
+    for (int i = 0; i < EVENT_LOOP_MAX_FDS; i++) {
+        if (sources[i].cb) continue;
+
+        struct epoll_event ev = {0};
+        ev.events = events;
+        ev.data.ptr = &sources[i];
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("epoll_ctl(ADD)");
+            return false;
+        }
+        sources[i].fd = fd;
+        sources[i].cb = cb;
+        sources[i].user_data = user_data;
+        return true;
+    }
+
+    LV_LOG_ERROR("event loop: no free slot for fd %d", fd);
+    return false;
+}
+
+bool event_loop_mod_fd(int fd, uint32_t events) {
+    event_loop_source_t * src = find_source(fd);
+    if (!src) return false;
+
+    struct epoll_event ev = {0};
+    ev.events = events;
+    ev.data.ptr = src;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void event_loop_remove_fd(int fd) {
+    event_loop_source_t * src = find_source(fd);
+    if (!src) return;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    src->cb = NULL;
+    src->user_data = NULL;
+    src->fd = -1;
+}
+
+void event_loop_run(void) {
+    struct epoll_event events[EVENT_LOOP_MAX_FDS + 1];
+
+    while (1) {
+        watchdog_beat();
+        uint32_t next = frame_sched_run();
+
+        // A timer is already due again: poll the fds without blocking.
+        // LV_NO_TIMER_READY disarms the timerfd and blocks until an fd event.
+        int timeout = -1;
+        if (next == 0) timeout = 0;
+        else arm_deadline(next);
+
+        // Idle cycles after the first frame run deferred startup work, one task at a time
+        if (timeout != 0 && startup_idle()) timeout = 0;
+
+        if (timeout != 0) {
+            tick_mark_idle();
+            watchdog_idle();
+        }
+        int n = epoll_wait(epoll_fd, events, EVENT_LOOP_MAX_FDS + 1, timeout);
+        if (n < 0) {
+            if (errno != EINTR) perror("epoll_wait");
+            continue;
+        }
+        if (n == 0) continue;
+
+        stats.wakeups++;
+        frame_sched_wake();
+        for (int i = 0; i < n; i++) {
+            event_loop_source_t * src = events[i].data.ptr;
+            if (src == NULL) {
+                uint64_t expirations;
+                while (read(deadline_fd, &expirations, sizeof(expirations)) > 0) {}
+                stats.timer_wakeups++;
+                if (deadline_ns) {
+                    uint64_t now = clock_ns(CLOCK_MONOTONIC);
+                    frame_sched_record_lateness(now > deadline_ns ? (uint32_t)((now - deadline_ns) / 1000ULL) : 0);
+                    deadline_ns = 0;
+                }
+                continue;
+            }
+            // The source may have been removed by an earlier callback in this batch
+            if (!src->cb) continue;
+            stats.fd_wakeups++;
+            src->cb(src->fd, events[i].events, src->user_data);
+        }
+    }
+}
+
+void event_loop_get_stats(event_loop_stats_t * out) {
+    *out = stats;
+    out->cpu_ns = clock_ns(CLOCK_PROCESS_CPUTIME_ID) - start_cpu_ns;
+    out->wall_ns = clock_ns(CLOCK_MONOTONIC) - start_wall_ns;
+}
+
+void event_loop_dump_stats(FILE * out) {
+    event_loop_stats_t now;
+    event_loop_get_stats(&now);
+
+    uint64_t wall = now.wall_ns - last_dump.wall_ns;
+    uint64_t cpu = now.cpu_ns - last_dump.cpu_ns;
+    uint64_t wakeups = now.wakeups - last_dump.wakeups;
+    double secs = wall / 1e9;
+    double cpu_pct = wall ? 100.0 * (double)cpu / (double)wall : 0.0;
+
+    fprintf(out, "[loop] %.1f s: %llu wakeups (%.1f/s, timer %llu, fd %llu), cpu %.2f%%, idle %.2f%%\n",
+            secs, (unsigned long long)wakeups, secs > 0 ? wakeups / secs : 0.0,
+            (unsigned long long)(now.timer_wakeups - last_dump.timer_wakeups),
+            (unsigned long long)(now.fd_wakeups - last_dump.fd_wakeups),
+            cpu_pct, 100.0 - cpu_pct);
+
+    last_dump = now;
+}
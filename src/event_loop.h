@@ -0,0 +1,67 @@
+/**
+ * @file event_loop.h
+ * @brief epoll based main loop: blocks until an fd is readable or the next LVGL timer is due.
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/epoll.h>
+
+// Maximum number of fds that can be registered at the same time
+#define EVENT_LOOP_MAX_FDS 16
+
+/**
+ * Called from the main (LVGL) thread when a registered fd becomes ready.
+ * @param fd the ready file descriptor
+ * @param events the EPOLL* event mask reported by epoll_wait()
+ * @param user_data pointer given at registration time
+ */
+typedef void (*event_loop_fd_cb_t)(int fd, uint32_t events, void * user_data);
+
+typedef struct {
+    uint64_t wakeups;        // Total returns from epoll_wait()
+    uint64_t timer_wakeups;  // Wakeups caused by the LVGL deadline timerfd
+    uint64_t fd_wakeups;     // Wakeups caused by a registered fd
+    uint64_t cpu_ns;         // Process CPU time since event_loop_init()
+    uint64_t wall_ns;        // Monotonic time since event_loop_init()
+} event_loop_stats_t;
+
+/**
+ * Create the epoll set and the deadline timerfd. Must be called after lv_init().
+ * @return false if the kernel objects could not be created
+ */
+bool event_loop_init(void);
+
+/**
+ * Add an fd to the loop. The callback runs on the main thread, so it may call LVGL.
+ * @return false if the table is full or epoll_ctl() failed
+ */
+bool event_loop_add_fd(int fd, uint32_t events, event_loop_fd_cb_t cb, void * user_data);
+
+/**
+ * Change the event mask of an already registered fd.
+ */
+bool event_loop_mod_fd(int fd, uint32_t events);
+
+/**
+ * Remove an fd from the loop. The fd itself is not closed.
+ */
+void event_loop_remove_fd(int fd);
+
+/**
+ * Run lv_timer_handler() and sleep until the next deadline or fd event. Never returns.
+ */
+void event_loop_run(void);
+
+void event_loop_get_stats(event_loop_stats_t * stats);
+
+/**
+ * Print wakeup rate and CPU/idle percentage since the previous dump.
+ */
+void event_loop_dump_stats(FILE * out);
+
+#endif // EVENT_LOOP_H
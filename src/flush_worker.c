@@ -0,0 +1,145 @@
+/**
+ * @file flush_worker.c
+ * @brief Runs the display flush on a worker thread so LVGL renders the next strip meanwhile.
+ *
+ * LVGL never has more than one flush in flight, so a single job slot is enough.
+ */
+
+#define _GNU_SOURCE
+
+#include "flush_worker.h"
+#include "rt_sched.h"
+#include <time.h>
+#include <pthread.h>
+
+typedef struct {
+    lv_disp_drv_t * drv;
+    lv_area_t area;
+    lv_color_t * color_p;
+} flush_job_t;
+
+static pthread_t thread;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_cond = PTHREAD_COND_INITIALIZER;    // A job was queued
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;   // The job slot is free again
+static flush_job_t job;
+static bool busy;           // The slot holds a queued or running job
+static bool running;
+static flush_worker_flush_t flush_fn;
+
+// Protected by lock
+static flush_worker_stats_t stats;
+static uint64_t frame_copy_ns;   // Copy time of the frame in progress
+static uint64_t frame_wait_ns;   // Main thread wait time since the previous frame ended
+
+// --- Helper Functions ---
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Share of the frame's copy time that ran while the main thread was rendering
+static void record_frame(void) {
+    uint64_t hidden = frame_copy_ns > frame_wait_ns ? frame_copy_ns - frame_wait_ns : 0;
+    uint32_t pct = frame_copy_ns ? (uint32_t)(hidden * 100 / frame_copy_ns) : 100;
+    uint32_t bucket = pct / (100 / FLUSH_WORKER_HIST_BUCKETS);
+    if (bucket >= FLUSH_WORKER_HIST_BUCKETS) bucket = FLUSH_WORKER_HIST_BUCKETS - 1;
+    stats.overlap_hist[bucket]++;
+    stats.frames++;
+    frame_copy_ns = 0;
+    frame_wait_ns = 0;
+}
+
+// --- Worker Thread ---
+static void * flush_worker_main(void * arg) {
+    pthread_mutex_lock(&lock);
+    while (1) {
+        while (!busy) pthread_cond_wait(&job_cond, &lock);
+        flush_job_t j = job;
+        pthread_mutex_unlock(&lock);
+
+        // flushing_last is cleared by lv_disp_flush_ready() inside the flush
+        bool last = lv_disp_flush_is_last(j.drv);
+        uint64_t t0 = now_ns();
+        flush_fn(j.drv, &j.area, j.color_p);
+        uint64_t dt = now_ns() - t0;
+
+        pthread_mutex_lock(&lock);
+        stats.flushes++;
+        stats.copy_ns += dt;
+        frame_copy_ns += dt;
+        if (last) record_frame();
+        busy = false;
+        pthread_cond_broadcast(&done_cond);
+    }
+    return NULL;
+}
+
+// --- Public API ---
+bool flush_worker_start(flush_worker_flush_t flush) {
+    flush_fn = flush;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, RT_SCHED_THREAD_STACK_SIZE);
+    int err = pthread_create(&thread, &attr, flush_worker_main, NULL);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        perror("flush worker: pthread_create");
+        return false;
+    }
+    running = true;
+    return true;
+}
+
+void flush_worker_submit(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p) {
+    pthread_mutex_lock(&lock);
+    // LVGL may see `flushing` cleared before the worker has released the slot
+    while (busy) pthread_cond_wait(&done_cond, &lock);
+    job.drv = drv;
+    job.area = *area;
+    job.color_p = color_p;
+    busy = true;
+    pthread_cond_signal(&job_cond);
+    pthread_mutex_unlock(&lock);
+}
+
+void flush_worker_wait(lv_disp_drv_t * drv) {
+    pthread_mutex_lock(&lock);
+    if (busy) {
+        uint64_t t0 = now_ns();
+        while (busy) pthread_cond_wait(&done_cond, &lock);
+        uint64_t dt = now_ns() - t0;
+        stats.wait_ns += dt;
+        frame_wait_ns += dt;
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+bool flush_worker_is_running(void) {
+    return running;
+}
+
+pthread_t flush_worker_get_thread(void) {
+    return thread;
+}
+
+void flush_worker_get_stats(flush_worker_stats_t * out) {
+    pthread_mutex_lock(&lock);
+    *out = stats;
+    pthread_mutex_unlock(&lock);
+}
+
+void flush_worker_dump_stats(FILE * out) {
+    if (!running) return;
+
+    flush_worker_stats_t s;
+    flush_worker_get_stats(&s);
+    uint64_t hidden = s.copy_ns > s.wait_ns ? s.copy_ns - s.wait_ns : 0;
+    fprintf(out, "[flush] %llu strips, %llu frames; copy %.3f ms/frame, main waited %.3f ms/frame, overlap %.0f%%\n",
+            (unsigned long long)s.flushes, (unsigned long long)s.frames,
+            s.frames ? s.copy_ns / 1e6 / s.frames : 0.0, s.frames ? s.wait_ns / 1e6 / s.frames : 0.0,
+            s.copy_ns ? 100.0 * hidden / s.copy_ns : 0.0);
+    fprintf(out, "[flush] frames by overlap: <25%% %u, <50%% %u, <75%% %u, >=75%% %u\n",
+            s.overlap_hist[0], s.overlap_hist[1], s.overlap_hist[2], s.overlap_hist[3]);
+}
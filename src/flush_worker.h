@@ -0,0 +1,55 @@
+/**
+ * @file flush_worker.h
+ * @brief Runs the display flush on a worker thread so LVGL renders the next strip meanwhile.
+ *
+ * With two draw buffers LVGL hands a finished strip to flush_cb and immediately starts
+ * rendering into the other buffer. The worker copies the strip to the framebuffer and calls
+ * lv_disp_flush_ready(); LVGL only blocks (in wait_cb) if it finishes the next strip first.
+ */
+
+#ifndef FLUSH_WORKER_H
+#define FLUSH_WORKER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "lvgl/lvgl.h"
+
+// Frames are binned by the share of their copy time that was hidden behind rendering:
+// <25%, <50%, <75%, >=75%
+#define FLUSH_WORKER_HIST_BUCKETS 4
+
+typedef void (*flush_worker_flush_t)(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
+
+typedef struct {
+    uint64_t flushes;        // Strips copied by the worker
+    uint64_t frames;         // Last strip of a refresh copied
+    uint64_t copy_ns;        // Worker time spent in the flush function
+    uint64_t wait_ns;        // Main thread time blocked on the worker
+    uint32_t overlap_hist[FLUSH_WORKER_HIST_BUCKETS];
+} flush_worker_stats_t;
+
+/**
+ * Start the worker.
+ * @param flush the real flush function; it must call lv_disp_flush_ready() (from the worker)
+ * @return false if the thread could not be created; use the flush function directly then
+ */
+bool flush_worker_start(flush_worker_flush_t flush);
+
+/**
+ * flush_cb: queue the strip for the worker. Blocks only while the previous strip is in flight.
+ */
+void flush_worker_submit(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
+
+/**
+ * wait_cb: sleep until the worker has finished the strip in flight.
+ */
+void flush_worker_wait(lv_disp_drv_t * drv);
+
+bool flush_worker_is_running(void);
+pthread_t flush_worker_get_thread(void);
+void flush_worker_get_stats(flush_worker_stats_t * stats);
+void flush_worker_dump_stats(FILE * out);
+
+#endif // FLUSH_WORKER_H
@@ -0,0 +1,130 @@
+/**
+ * @file frame_sched.c
+ * @brief Decides how long the main loop may sleep after each lv_timer_handler() pass.
+ */
+
+#include "frame_sched.h"
+#include "tick.h"
+#include "rt_sched.h"
+#include "lvgl/lvgl.h"
+
+#ifndef LV_NO_TIMER_READY
+#define LV_NO_TIMER_READY 0xFFFFFFFF
+#endif
+
+static const uint32_t late_bucket_us[FRAME_SCHED_LATE_BUCKETS - 1] = {100, 500, 1000, 2000, 5000, 10000};
+
+static const uint32_t frame_bucket_ms[FRAME_SCHED_FRAME_BUCKETS - 1] = {1, 2, 5, 10, 20, 50};
+static const char * mode_names[FRAME_SCHED_MODE_CNT] = {"normal", "rt"};
+
+static frame_sched_stats_t stats;
+static bool render_enabled = true;
+
+static lv_timer_t * refr_timer(void) {
+    lv_disp_t * disp = lv_disp_get_default();
+    return disp ? _lv_disp_get_refr_timer(disp) : NULL;
+}
+
+// Nothing waits to be drawn and nothing moves: the refresh timer has no work to do
+static bool display_is_idle(void) {
+    lv_disp_t * disp = lv_disp_get_default();
+    return disp && disp->inv_p == 0 && lv_anim_count_running() == 0;
+}
+
+static void record_frame_time(uint64_t us) {
+    frame_sched_mode_t mode = rt_sched_is_active() ? FRAME_SCHED_MODE_RT : FRAME_SCHED_MODE_NORMAL;
+    int b = 0;
+    while (b < FRAME_SCHED_FRAME_BUCKETS - 1 && us >= frame_bucket_ms[b] * 1000ULL) b++;
+    stats.frame_hist[mode][b]++;
+    stats.frames[mode]++;
+    if (us > stats.frame_max_us[mode]) stats.frame_max_us[mode] = us;
+}
+
+uint32_t frame_sched_run(void) {
+    stats.passes++;
+    lv_timer_t * refr = refr_timer();
+
+    // Only passes that may render count as frames; parked passes take microseconds
+    bool may_render = refr && !refr->paused;
+    uint64_t start = may_render ? tick_get_us() : 0;
+    uint32_t next = lv_timer_handler();
+    if (may_render) record_frame_time(tick_get_us() - start);
+
+    // While animating, LVGL's own deadline already follows LV_DISP_DEF_REFR_PERIOD
+    if (!refr) return next;
+    if (!render_enabled) {
+        lv_timer_pause(refr);
+        return lv_timer_handler();
+    }
+    if (!display_is_idle()) {
+        // The refresh timer may still be parked from an earlier pass if the loop came back
+        // without frame_sched_wake() (a zero timeout or EINTR): render what was just invalidated
+        if (refr->paused) {
+            lv_timer_resume(refr);
+            return 0;
+        }
+        return next;
+    }
+
+    // Park the refresh timer and ask LVGL again for the earliest remaining deadline.
+    // This second pass may run a timer that invalidates something; render it right away.
+    lv_timer_pause(refr);
+    next = lv_timer_handler();
+    if (!display_is_idle()) {
+        lv_timer_resume(refr);
+        return 0;
+    }
+
+    stats.idle_passes++;
+    return next;
+}
+
+void frame_sched_wake(void) {
+    lv_timer_t * refr = refr_timer();
+    if (refr && render_enabled) lv_timer_resume(refr);
+}
+
+void frame_sched_set_render_enabled(bool enabled) {
+    render_enabled = enabled;
+    lv_timer_t * refr = refr_timer();
+    if (!refr) return;
+    if (enabled) lv_timer_resume(refr);
+    else lv_timer_pause(refr);
+}
+
+void frame_sched_record_lateness(uint32_t late_us) {
+    int b = 0;
+    while (b < FRAME_SCHED_LATE_BUCKETS - 1 && late_us >= late_bucket_us[b]) b++;
+    stats.late_hist[b]++;
+    stats.late_samples++;
+    stats.late_sum_us += late_us;
+    if (late_us > stats.late_max_us) stats.late_max_us = late_us;
+}
+
+void frame_sched_get_stats(frame_sched_stats_t * out) {
+    *out = stats;
+}
+
+void frame_sched_dump_stats(FILE * out) {
+    fprintf(out, "[sched] %llu passes, %llu parked; wakeup lateness: avg %llu us, max %u us\n",
+            (unsigned long long)stats.passes, (unsigned long long)stats.idle_passes,
+            stats.late_samples ? (unsigned long long)(stats.late_sum_us / stats.late_samples) : 0ULL,
+            stats.late_max_us);
+    fprintf(out, "[sched] lateness histogram:");
+    for (int b = 0; b < FRAME_SCHED_LATE_BUCKETS; b++) {
+        if (b < FRAME_SCHED_LATE_BUCKETS - 1) fprintf(out, " <%uus:%llu", late_bucket_us[b], (unsigned long long)stats.late_hist[b]);
+        else fprintf(out, " >=%uus:%llu", late_bucket_us[b - 1], (unsigned long long)stats.late_hist[b]);
+    }
+    fprintf(out, "\n");
+
+    for (int m = 0; m < FRAME_SCHED_MODE_CNT; m++) {
+        if (!stats.frames[m]) continue;
+        fprintf(out, "[sched] %s frame times (%llu, max %llu us):", mode_names[m],
+                (unsigned long long)stats.frames[m], (unsigned long long)stats.frame_max_us[m]);
+        for (int b = 0; b < FRAME_SCHED_FRAME_BUCKETS; b++) {
+            if (b < FRAME_SCHED_FRAME_BUCKETS - 1) fprintf(out, " <%ums:%llu", frame_bucket_ms[b], (unsigned long long)stats.frame_hist[m][b]);
+            else fprintf(out, " >=%ums:%llu", frame_bucket_ms[b - 1], (unsigned long long)stats.frame_hist[m][b]);
+        }
+        fprintf(out, "\n");
+    }
+}
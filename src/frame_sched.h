@@ -0,0 +1,66 @@
+/**
+ * @file frame_sched.h
+ * @brief Decides how long the main loop may sleep after each lv_timer_handler() pass.
+ *
+ * The display refresh timer only runs while something is invalidated or animating.
+ * When nothing is pending the loop sleeps until the next real LVGL timer (or forever).
+ */
+
+#ifndef FRAME_SCHED_H
+#define FRAME_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Upper bounds (in us) of the wakeup lateness histogram buckets; the last bucket is open ended
+#define FRAME_SCHED_LATE_BUCKETS 7
+// Upper bounds (in ms) of the frame time histogram buckets; the last bucket is open ended
+#define FRAME_SCHED_FRAME_BUCKETS 7
+
+// Frame time histograms are kept separately for normal and SCHED_FIFO scheduling
+typedef enum {
+    FRAME_SCHED_MODE_NORMAL = 0,
+    FRAME_SCHED_MODE_RT,
+    FRAME_SCHED_MODE_CNT
+} frame_sched_mode_t;
+
+typedef struct {
+    uint64_t passes;         // lv_timer_handler() passes
+    uint64_t idle_passes;    // Passes after which the refresh timer was parked
+    uint64_t late_samples;   // Deadline wakeups measured
+    uint64_t late_sum_us;
+    uint32_t late_max_us;
+    uint64_t late_hist[FRAME_SCHED_LATE_BUCKETS];
+    uint64_t frames[FRAME_SCHED_MODE_CNT];   // Passes with the refresh timer armed
+    uint64_t frame_max_us[FRAME_SCHED_MODE_CNT];
+    uint64_t frame_hist[FRAME_SCHED_MODE_CNT][FRAME_SCHED_FRAME_BUCKETS];
+} frame_sched_stats_t;
+
+/**
+ * Run LVGL once and return the ms until the next deadline,
+ * or LV_NO_TIMER_READY when the loop may block until an fd event.
+ */
+uint32_t frame_sched_run(void);
+
+/**
+ * Call after every wakeup, before the next frame_sched_run(), so work triggered
+ * by input or by a due timer gets rendered.
+ */
+void frame_sched_wake(void);
+
+/**
+ * Stop (false) or restart (true) display refreshes, e.g. while the panel is blanked.
+ * Invalidations made while disabled are kept by LVGL and drawn once re-enabled.
+ */
+void frame_sched_set_render_enabled(bool enabled);
+
+/**
+ * Record how late a deadline wakeup was compared to the time it was armed for.
+ */
+void frame_sched_record_lateness(uint32_t late_us);
+
+void frame_sched_get_stats(frame_sched_stats_t * stats);
+void frame_sched_dump_stats(FILE * out);
+
+#endif // FRAME_SCHED_H
@@ -0,0 +1,231 @@
+/**
+ * @file idle_power.c
+ * @brief Idle governor: lowers the refresh/input rate, then blanks the panel when nobody presses a key.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "idle_power.h"
+#include "tick.h"
+#include "frame_sched.h"
+#include "lv_drivers/display/fbdev.h"
+#include <unistd.h>
+#include <dirent.h>
+#include <string.h>
+#include <limits.h>
+#include <linux/input.h>
+
+#define BACKLIGHT_CLASS_DIR "/sys/class/backlight"
+
+static const char * state_names[IDLE_POWER_STATE_CNT] = {"active", "reduced", "blanked"};
+
+static lv_indev_t * keypad_indev;
+static lv_timer_t * governor_timer;
+static idle_power_state_cb_t state_cb;
+static idle_power_state_t state = IDLE_POWER_ACTIVE;
+
+static uint32_t reduce_ms;
+static uint32_t blank_ms;
+static uint64_t last_input_ms;
+
+// Residency accounting
+static uint64_t state_enter_ms;
+static uint64_t residency_ms[IDLE_POWER_STATE_CNT];
+static uint64_t wakeups_from_blank;
+
+// Wake-up key swallowing: events are dropped until this key is released again
+static bool swallowing;
+static uint16_t swallow_code;
+
+// Backlight fallback when FBIOBLANK is refused
+static char backlight_path[PATH_MAX];
+static char backlight_saved[16];
+static bool used_backlight;
+
+// --- Helper Functions ---
+static bool find_backlight(void) {
+    if (backlight_path[0]) return true;
+    DIR * d = opendir(BACKLIGHT_CLASS_DIR);
+    if (!d) return false;
+    struct dirent * e;
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        int n = snprintf(backlight_path, sizeof(backlight_path), BACKLIGHT_CLASS_DIR "/%s/brightness", e->d_name);
+        if (n > 0 && (size_t)n < sizeof(backlight_path)) break;
+        backlight_path[0] = '\0';   // Does not fit: try the next entry
+    }
+    closedir(d);
+    return backlight_path[0] != '\0';
+}
+
+static bool backlight_write(const char * value) {
+    FILE * fp = fopen(backlight_path, "w");
+    if (!fp) return false;
+    fputs(value, fp);
+    fclose(fp);
+    return true;
+}
+
+static void panel_off(void) {
+    used_backlight = false;
+    if (fbdev_blank(true)) return;
+
+    // Panel driver without blanking support: switch the backlight off instead
+    if (!find_backlight()) return;
+    FILE * fp = fopen(backlight_path, "r");
+    if (fp) {
+        if (!fgets(backlight_saved, sizeof(backlight_saved), fp)) backlight_saved[0] = '\0';
+        fclose(fp);
+    }
+    if (backlight_saved[0] && backlight_write("0")) used_backlight = true;
+}
+
+static void panel_on(void) {
+    if (used_backlight) backlight_write(backlight_saved);
+    else fbdev_blank(false);
+    used_backlight = false;
+}
+
+static void set_periods(uint32_t period) {
+    lv_disp_t * disp = lv_disp_get_default();
+    if (disp) lv_timer_set_period(_lv_disp_get_refr_timer(disp), period);
+    if (keypad_indev) lv_timer_set_period(keypad_indev->driver->read_timer, period);
+}
+
+static void enter_state(idle_power_state_t next) {
+    if (next == state) return;
+
+    uint64_t now = tick_get_ms64();
+    residency_ms[state] += now - state_enter_ms;
+    state_enter_ms = now;
+
+    idle_power_state_t prev = state;
+    state = next;
+
+    if (prev == IDLE_POWER_BLANKED) {
+        panel_on();
+        frame_sched_set_render_enabled(true);
+        // Nothing was drawn while blanked
+        lv_obj_invalidate(lv_scr_act());
+    }
+
+    switch (next) {
+        case IDLE_POWER_ACTIVE:
+            set_periods(LV_DISP_DEF_REFR_PERIOD);
+            break;
+        case IDLE_POWER_REDUCED:
+            set_periods(IDLE_POWER_REDUCED_PERIOD_MS);
+            break;
+        case IDLE_POWER_BLANKED:
+            frame_sched_set_render_enabled(false);
+            panel_off();
+            break;
+        default:
+            break;
+    }
+
+    if (state_cb) state_cb(next);
+}
+
+// Re-arm the governor timer for the next transition, or park it if there is none
+static void schedule_governor(void) {
+    if (!governor_timer) return;
+
+    uint64_t idle = tick_get_ms64() - last_input_ms;
+    uint64_t due = 0;
+    if (state == IDLE_POWER_ACTIVE && reduce_ms) due = reduce_ms;
+    else if (state != IDLE_POWER_BLANKED && blank_ms) due = blank_ms;
+
+    if (due == 0) {
+        lv_timer_pause(governor_timer);
+        return;
+    }
+    lv_timer_set_period(governor_timer, due > idle ? (uint32_t)(due - idle) : 1);
+    lv_timer_reset(governor_timer);
+    lv_timer_resume(governor_timer);
+}
+
+static void governor_timer_cb(lv_timer_t * timer) {
+    uint64_t idle = tick_get_ms64() - last_input_ms;
+
+    if (blank_ms && idle >= blank_ms) enter_state(IDLE_POWER_BLANKED);
+    else if (reduce_ms && idle >= reduce_ms && state == IDLE_POWER_ACTIVE) enter_state(IDLE_POWER_REDUCED);
+
+    schedule_governor();
+}
+
+// Track the key that woke the panel; true while events are being dropped
+static bool swallow_key(uint16_t code, int32_t value) {
+    if (!swallowing) return false;
+    if (swallow_code == 0 && value == 1) swallow_code = code;
+    else if (code == swallow_code && value == 0) swallowing = false;
+    return true;
+}
+
+// Any input: leave the reduced/blanked state. Waking from blank starts swallowing.
+static void note_activity(void) {
+    last_input_ms = tick_get_ms64();
+
+    if (state == IDLE_POWER_BLANKED) {
+        wakeups_from_blank++;
+        swallowing = true;
+        swallow_code = 0;
+    }
+    if (state != IDLE_POWER_ACTIVE) enter_state(IDLE_POWER_ACTIVE);
+    schedule_governor();
+}
+
+// --- Public API ---
+void idle_power_init(lv_indev_t * keypad, uint32_t reduce_secs, uint32_t blank_secs) {
+    keypad_indev = keypad;
+    state_enter_ms = last_input_ms = tick_get_ms64();
+    governor_timer = lv_timer_create(governor_timer_cb, 1000, NULL);
+    idle_power_set_timeouts(reduce_secs, blank_secs);
+}
+
+void idle_power_set_timeouts(uint32_t reduce_secs, uint32_t blank_secs) {
+    reduce_ms = reduce_secs * 1000;
+    blank_ms = blank_secs * 1000;
+    schedule_governor();
+}
+
+void idle_power_set_state_cb(idle_power_state_cb_t cb) {
+    state_cb = cb;
+}
+
+bool idle_power_input_ready(int evdev_fd) {
+    note_activity();
+    if (!swallowing) return false;
+
+    // Drop everything up to and including the release of the key that woke the panel
+    struct input_event in;
+    while (read(evdev_fd, &in, sizeof(in)) == sizeof(in)) {
+        if (in.type == EV_KEY) swallow_key(in.code, in.value);
+    }
+    return true;
+}
+
+bool idle_power_filter_key(uint16_t code, int32_t value) {
+    note_activity();
+    return swallow_key(code, value);
+}
+
+idle_power_state_t idle_power_get_state(void) {
+    return state;
+}
+
+void idle_power_get_residency(uint64_t ms[IDLE_POWER_STATE_CNT]) {
+    for (int i = 0; i < IDLE_POWER_STATE_CNT; i++) ms[i] = residency_ms[i];
+    ms[state] += tick_get_ms64() - state_enter_ms;
+}
+
+void idle_power_dump_stats(FILE * out) {
+    uint64_t ms[IDLE_POWER_STATE_CNT];
+    idle_power_get_residency(ms);
+    fprintf(out, "[power] state %s, wakeups from blank %llu; residency:",
+            state_names[state], (unsigned long long)wakeups_from_blank);
+    for (int i = 0; i < IDLE_POWER_STATE_CNT; i++) {
+        fprintf(out, " %s %.1f s", state_names[i], ms[i] / 1000.0);
+    }
+    fprintf(out, "\n");
+}
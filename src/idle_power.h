@@ -0,0 +1,67 @@
+/**
+ * @file idle_power.h
+ * @brief Idle governor: lowers the refresh/input rate, then blanks the panel when nobody presses a key.
+ */
+
+#ifndef IDLE_POWER_H
+#define IDLE_POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "lvgl/lvgl.h"
+
+// Refresh / indev read period used in the reduced state
+#define IDLE_POWER_REDUCED_PERIOD_MS 50
+
+typedef enum {
+    IDLE_POWER_ACTIVE = 0,
+    IDLE_POWER_REDUCED,   // Lower refresh and indev polling rate
+    IDLE_POWER_BLANKED,   // Panel blanked (or backlight off), rendering stopped
+    IDLE_POWER_STATE_CNT
+} idle_power_state_t;
+
+typedef void (*idle_power_state_cb_t)(idle_power_state_t state);
+
+/**
+ * Start the governor.
+ * @param keypad the keypad indev whose read period is lowered in the reduced state
+ * @param reduce_secs seconds without input before entering IDLE_POWER_REDUCED, 0 = never
+ * @param blank_secs seconds without input before entering IDLE_POWER_BLANKED, 0 = never
+ */
+void idle_power_init(lv_indev_t * keypad, uint32_t reduce_secs, uint32_t blank_secs);
+
+/**
+ * Change the timeouts at runtime (e.g. after the preferences were edited).
+ */
+void idle_power_set_timeouts(uint32_t reduce_secs, uint32_t blank_secs);
+
+/**
+ * Called for every state change, e.g. to stop timers that only update the screen.
+ */
+void idle_power_set_state_cb(idle_power_state_cb_t cb);
+
+/**
+ * Report that the evdev fd is readable. Wakes the display if needed.
+ * @return true if the pending events were consumed as the wake-up key press
+ *         and must not be passed on to LVGL
+ */
+bool idle_power_input_ready(int evdev_fd);
+
+/**
+ * Report one key event that was already read from evdev (e.g. by the input thread).
+ * @param code EV_KEY code
+ * @param value 1 = press, 0 = release, 2 = autorepeat
+ * @return true if the event belongs to the wake-up key press and must be dropped
+ */
+bool idle_power_filter_key(uint16_t code, int32_t value);
+
+idle_power_state_t idle_power_get_state(void);
+
+/**
+ * Milliseconds spent in each state, including the current one.
+ */
+void idle_power_get_residency(uint64_t ms[IDLE_POWER_STATE_CNT]);
+void idle_power_dump_stats(FILE * out);
+
+#endif // IDLE_POWER_H
@@ -0,0 +1,211 @@
+/**
+ * @file input_thread.c
+ * @brief Captures evdev key events on a dedicated thread and hands them to the LVGL keypad read_cb.
+ */
+
+#define _GNU_SOURCE
+
+#include "input_thread.h"
+#include "rt_sched.h"
+#include "lv_drivers/indev/evdev.h"
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#include <linux/input.h>
+
+// Older kernel headers only have the timeval member
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+#define READ_BATCH 16
+
+typedef struct {
+    uint64_t time_us;   // Kernel timestamp of the event
+    int32_t value;
+    uint16_t code;
+} input_key_event_t;
+
+static input_key_event_t ring[INPUT_RING_SIZE];
+static volatile uint32_t ring_head;   // Written by the producer
+static volatile uint32_t ring_tail;   // Written by the consumer
+
+static int evdev_fd = -1;
+static int wake_fd = -1;
+static clockid_t event_clock = CLOCK_REALTIME;
+static pthread_t thread;
+static input_thread_filter_t filter_cb;
+
+// Last key reported to LVGL; repeated while the ring is empty so held keys stay pressed
+static uint32_t last_key;
+static lv_indev_state_t last_state = LV_INDEV_STATE_REL;
+
+static volatile uint64_t captured;
+static volatile uint64_t dropped;
+static input_thread_stats_t stats;
+
+// --- Ring ---
+static bool ring_push(const input_key_event_t * ev) {
+    uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= INPUT_RING_SIZE) return false;
+    ring[head & (INPUT_RING_SIZE - 1)] = *ev;
+    __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool ring_pop(input_key_event_t * ev) {
+    uint32_t tail = __atomic_load_n(&ring_tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    if (head == tail) return false;
+    *ev = ring[tail & (INPUT_RING_SIZE - 1)];
+    __atomic_store_n(&ring_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool ring_empty(void) {
+    return __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE) == __atomic_load_n(&ring_tail, __ATOMIC_RELAXED);
+}
+
+// --- Capture Thread ---
+static void * input_thread_main(void * arg) {
+    struct pollfd pfd = { .fd = evdev_fd, .events = POLLIN };
+    struct input_event in[READ_BATCH];
+
+    while (1) {
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("input thread: poll");
+            return NULL;
+        }
+
+        bool queued = false;
+        ssize_t len;
+        while ((len = read(evdev_fd, in, sizeof(in))) > 0) {
+            int n = len / sizeof(struct input_event);
+            for (int i = 0; i < n; i++) {
+                if (in[i].type != EV_KEY) continue;
+                input_key_event_t ev = {
+                    .time_us = (uint64_t)in[i].input_event_sec * 1000000ULL + (uint64_t)in[i].input_event_usec,
+                    .value = in[i].value,
+                    .code = in[i].code,
+                };
+                __atomic_add_fetch(&captured, 1, __ATOMIC_RELAXED);
+                if (ring_push(&ev)) queued = true;
+                else __atomic_add_fetch(&dropped, 1, __ATOMIC_RELAXED);
+            }
+        }
+        if (len < 0 && errno != EAGAIN && errno != EINTR) {
+            perror("input thread: read");
+            return NULL;
+        }
+
+        if (queued) {
+            uint64_t one = 1;
+            write(wake_fd, &one, sizeof(one));
+        }
+    }
+    return NULL;
+}
+
+// --- Public API ---
+bool input_thread_start(int fd) {
+    if (fd < 0) return false;
+    evdev_fd = fd;
+
+    // Ask for CLOCK_MONOTONIC event timestamps so latencies survive `date -s`
+    int clk = CLOCK_MONOTONIC;
+#ifdef EVIOCSCLOCKID
+    if (ioctl(evdev_fd, EVIOCSCLOCKID, &clk) == 0) event_clock = CLOCK_MONOTONIC;
+#endif
+
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        perror("input thread: eventfd");
+        return false;
+    }
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, RT_SCHED_THREAD_STACK_SIZE);
+    int err = pthread_create(&thread, &attr, input_thread_main, NULL);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        perror("input thread: pthread_create");
+        close(wake_fd);
+        wake_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+pthread_t input_thread_get_thread(void) {
+    return thread;
+}
+
+int input_thread_get_wake_fd(void) {
+    return wake_fd;
+}
+
+void input_thread_ack(void) {
+    uint64_t cnt;
+    read(wake_fd, &cnt, sizeof(cnt));
+}
+
+void input_thread_set_filter(input_thread_filter_t filter) {
+    filter_cb = filter;
+}
+
+void input_thread_read(lv_indev_drv_t * drv, lv_indev_data_t * data) {
+    input_key_event_t ev;
+
+    while (ring_pop(&ev)) {
+        if (filter_cb && filter_cb(ev.code, ev.value)) {
+            stats.filtered++;
+            continue;
+        }
+        uint32_t key = evdev_key_to_lv(ev.code, ev.value != 0);
+        if (key == 0) continue;
+
+        struct timespec ts;
+        clock_gettime(event_clock, &ts);
+        uint64_t now_us = (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+        uint32_t latency = now_us > ev.time_us ? (uint32_t)(now_us - ev.time_us) : 0;
+        stats.latency_sum_us += latency;
+        if (latency > stats.latency_max_us) stats.latency_max_us = latency;
+        stats.delivered++;
+
+        last_key = key;
+        last_state = ev.value ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+        data->key = last_key;
+        data->state = last_state;
+        data->continue_reading = !ring_empty();
+        return;
+    }
+
+    data->key = last_key;
+    data->state = last_state;
+    data->continue_reading = false;
+}
+
+void input_thread_get_stats(input_thread_stats_t * out) {
+    *out = stats;
+    out->captured = __atomic_load_n(&captured, __ATOMIC_RELAXED);
+    out->dropped = __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
+
+void input_thread_dump_stats(FILE * out) {
+    if (wake_fd < 0) return;
+
+    input_thread_stats_t s;
+    input_thread_get_stats(&s);
+    fprintf(out, "[input] captured %llu, delivered %llu, filtered %llu, dropped %llu; latency avg %llu us, max %u us (%s)\n",
+            (unsigned long long)s.captured, (unsigned long long)s.delivered,
+            (unsigned long long)s.filtered, (unsigned long long)s.dropped,
+            s.delivered ? (unsigned long long)(s.latency_sum_us / s.delivered) : 0ULL, s.latency_max_us,
+            event_clock == CLOCK_MONOTONIC ? "monotonic" : "realtime");
+}
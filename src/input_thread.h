@@ -0,0 +1,62 @@
+/**
+ * @file input_thread.h
+ * @brief Captures evdev key events on a dedicated thread and hands them to the LVGL keypad read_cb.
+ *
+ * The thread blocks on the evdev fd, stamps each key event with its kernel timestamp and pushes it
+ * into a single-producer/single-consumer ring. An eventfd wakes the main loop; the keypad read_cb
+ * drains the ring with `continue_reading`, so presses made during a long render are neither
+ * delayed by the indev read period nor collapsed.
+ */
+
+#ifndef INPUT_THREAD_H
+#define INPUT_THREAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "lvgl/lvgl.h"
+
+// Ring capacity in key events, must be a power of two
+#define INPUT_RING_SIZE 64
+
+/**
+ * Decide whether a key event is dropped before it reaches LVGL.
+ * @return true to drop the event
+ */
+typedef bool (*input_thread_filter_t)(uint16_t code, int32_t value);
+
+typedef struct {
+    uint64_t captured;        // Key events read from evdev
+    uint64_t dropped;         // Lost because the ring was full
+    uint64_t filtered;        // Dropped by the filter callback
+    uint64_t delivered;       // Handed to LVGL
+    uint64_t latency_sum_us;  // Kernel timestamp -> read_cb, summed over delivered events
+    uint32_t latency_max_us;
+} input_thread_stats_t;
+
+/**
+ * Start the capture thread on an already opened, non-blocking evdev fd.
+ * @return false if the thread or the wake eventfd could not be created
+ */
+bool input_thread_start(int evdev_fd);
+pthread_t input_thread_get_thread(void);
+
+/**
+ * eventfd that becomes readable when new events are queued. Register it with the event loop
+ * and call input_thread_ack() from its callback.
+ */
+int input_thread_get_wake_fd(void);
+void input_thread_ack(void);
+
+void input_thread_set_filter(input_thread_filter_t filter);
+
+/**
+ * LVGL keypad read_cb draining the ring. Main thread only.
+ */
+void input_thread_read(lv_indev_drv_t * drv, lv_indev_data_t * data);
+
+void input_thread_get_stats(input_thread_stats_t * stats);
+void input_thread_dump_stats(FILE * out);
+
+#endif // INPUT_THREAD_H
@@ -321,6 +321,14 @@
 
 #if USE_FBDEV
 #  define FBDEV_PATH          "/dev/fb0"
+#  define FBDEV_PAGE_FLIP     1   /*Render into a back page and flip with FBIOPAN_DISPLAY if yres_virtual >= 2 * yres*/
+#  define FBDEV_WAIT_VSYNC    1   /*Wait for FBIO_WAITFORVSYNC after each flip*/
+#  define FBDEV_SHADOW        0   /*Diff against a RAM shadow and write only changed pixels (SPI panels), see fbdev_set_shadow()*/
+#  define FBDEV_ROTATION      0   /*Clockwise panel rotation in degrees (0, 90, 180, 270), see fbdev_set_rotation()*/
+#  define FBDEV_1BPP_DITHER   1   /*Monochrome panels: ordered dithering instead of a 50% luminance threshold*/
+#  define FBDEV_1BPP_MSB_FIRST 0  /*Monochrome panels: leftmost pixel in the most significant bit*/
+#  define FBDEV_NEGOTIATE     0   /*Switch the mode to LV_COLOR_DEPTH / two pages at init, see fbdev_set_negotiate()*/
+#  define FBDEV_COPY_STREAM   1   /*Aligned 64 byte bursts (NEON / SSE2 streaming stores) instead of memcpy() into the framebuffer*/
 #endif
 
 /*-----------------------------------------
@@ -1,25 +1,44 @@
 /**
  * @file main.c
  * @author Gemini & User
- * @brief Optimized LVGL menu for 320x240 resolution on Luckfox Pico.
+ * @brief Optimized LVGL menu for Luckfox Pico; laid out for 320x240 and scaled to the panel.
  */
 
 #define _DEFAULT_SOURCE // For usleep declaration
 
 #include "lvgl/lvgl.h"
 #include "lv_drivers/display/fbdev.h"
+#include "lv_drivers/display/fbdev_pixconv.h"
 #include "lv_drivers/indev/evdev.h"
+#include "event_loop.h"
+#include "tick.h"
+#include "frame_sched.h"
+#include "idle_power.h"
+#include "rt_sched.h"
+#include "watchdog.h"
+#include "input_thread.h"
+#include "ui_queue.h"
+#include "clock_sprite.h"
+#include "boot_splash.h"
+#include "startup.h"
+#include "flush_worker.h"
+#include "area_coalesce.h"
 #include <unistd.h>
+#include <signal.h>
+#include <sys/signalfd.h>
 #include <pthread.h>
 #include <time.h>
-#include <sys/time.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
+#include <sys/stat.h>
 #include <linux/input-event-codes.h> 
 
-#define DISP_BUF_SIZE (320 * 20) // Slightly increased buffer for better performance
+// Layouts are designed for 320x240 and scaled to the detected resolution
+#define UI_REF_HOR_RES 320
+#define UI_REF_VER_RES 240
+#define DRAW_BUF_DEFAULT_PCT 10   // Share of the screen per draw buffer
 
 // --- Configuration ---
 #define EVDEV_PATH "/dev/input/event0"
@@ -42,13 +61,39 @@ lv_obj_t * nes_browser_screen;
 lv_obj_t * stella_browser_screen;
 
 // Custom Styles
-static lv_style_t style_nes_cjk;
+static lv_style_t style_nes_cjk;    // Only the ROM browsers use it: built on first use or pre-warm
+static bool style_nes_cjk_ready;
 static lv_style_t style_compact_list;
 static lv_style_t style_compact_btn;
 
 // --- Global Preferences ---
 bool show_seconds = true;
 bool is_24_hour_format = true;
+uint32_t idle_reduce_secs = 30;   // Lower refresh/input rate after this much inactivity, 0 = never
+uint32_t idle_blank_secs = 300;   // Blank the panel after this much inactivity, 0 = never
+int rt_priority = 0;              // SCHED_FIFO priority for the UI thread, 0 = normal scheduling
+uint32_t rt_cpu_mask = 0;         // CPUs the UI thread is pinned to in RT mode, 0 = any
+// Command line overrides, used for this run only and never written back to the preferences file
+static int arg_rt_priority = -1;  // --rt, -1 = RT_PRIORITY
+static uint32_t arg_rt_cpu_mask = 0;  // --cpus, 0 = RT_CPU_MASK
+static uint32_t watchdog_thresholds[WATCHDOG_MAX_THRESHOLDS];
+static int watchdog_threshold_cnt = 0;  // 0 = built-in 50/250/1000 ms
+static lv_timer_t * time_timer;
+static bool sync_flush = false;   // Copy strips on the main thread instead of the flush worker
+static bool eager_init = false;   // Build everything before the first frame (old behaviour, for comparison)
+static bool run_selftest = false;  // Check the pixel converters and exit
+static bool shadow_fb = false;    // Only write changed pixels to the framebuffer (SPI panels)
+static uint32_t draw_buf_pct = DRAW_BUF_DEFAULT_PCT;  // Draw buffer size as % of the screen
+static uint32_t draw_buf_kb = 0;  // Memory budget for all draw buffers in KiB, 0 = no limit
+static uint32_t arg_draw_buf_pct = 0;  // --draw-buf=N% for this run only, 0 = DRAW_BUF_PCT
+static uint32_t arg_draw_buf_kb = 0;   // --draw-buf=Nk for this run only, 0 = DRAW_BUF_KB
+static uint32_t ui_scale = 0;     // Integer upscale of the 320x240 UI on large screens, 0 = auto, 1 = off
+static int arg_ui_scale = -1;     // --scale for this run only, -1 = UI_SCALE
+static int disp_rotation = -1;    // Clockwise panel rotation in degrees, -1 = FBDEV_ROTATION
+static int arg_disp_rotation = -1;  // --rotate for this run only, -1 = DISP_ROTATION
+static bool fb_negotiate = false; // Switch the framebuffer to 16 bpp / two pages, restored on exit
+static fbdev_file_t fb_file;      // Memory-backed framebuffer from --fb-file, empty path = FBDEV_PATH
+static uint32_t coalesce_cost_px = AREA_COALESCE_DEFAULT_CALL_COST_PX;  // Per-area overhead for merging invalidated areas, 0 = off
 
 // --- Forward Declarations ---
 void create_main_menu(lv_obj_t * parent, lv_group_t * g);
@@ -80,6 +125,49 @@ void create_stella_browser_screen(lv_obj_t * parent);
 static void stella_browser_screen_close_cb(lv_event_t * e);
 static void stella_game_launch_event_handler(lv_event_t * e);
 
+// --- Layout Scaling ---
+static lv_coord_t ui_w(lv_coord_t w) {
+    return (lv_coord_t)((int32_t)w * LV_HOR_RES / UI_REF_HOR_RES);
+}
+
+static lv_coord_t ui_h(lv_coord_t h) {
+    return (lv_coord_t)((int32_t)h * LV_VER_RES / UI_REF_VER_RES);
+}
+
+// Montserrat sizes built in (lv_conf.h), smallest first
+static const struct {
+    lv_coord_t px;
+    const lv_font_t * font;
+} ui_fonts[] = {
+#if LV_FONT_MONTSERRAT_10
+    {10, &lv_font_montserrat_10},
+#endif
+    {12, &lv_font_montserrat_12},
+    {14, &lv_font_montserrat_14},
+    {16, &lv_font_montserrat_16},
+#if LV_FONT_MONTSERRAT_18
+    {18, &lv_font_montserrat_18},
+#endif
+#if LV_FONT_MONTSERRAT_20
+    {20, &lv_font_montserrat_20},
+#endif
+#if LV_FONT_MONTSERRAT_28
+    {28, &lv_font_montserrat_28},
+#endif
+    {36, &lv_font_montserrat_36},
+};
+
+// The layout's `px` font at the detected resolution: the largest built-in size not above
+// px scaled with the screen height, like the rows the text sits in
+static const lv_font_t * ui_font(lv_coord_t px) {
+    lv_coord_t want = ui_h(px);
+    const lv_font_t * font = ui_fonts[0].font;
+    for (size_t i = 0; i < sizeof(ui_fonts) / sizeof(ui_fonts[0]) && ui_fonts[i].px <= want; i++) {
+        font = ui_fonts[i].font;
+    }
+    return font;
+}
+
 // --- Style Initialization ---
 void init_custom_styles() {
     // Compact List Style (保持黑色背景和间隙)
@@ -87,7 +175,7 @@ void init_custom_styles() {
     lv_style_set_bg_color(&style_compact_list, lv_color_hex(0x000000)); // 纯黑底
     lv_style_set_radius(&style_compact_list, 0);
     lv_style_set_pad_all(&style_compact_list, 0);
-    lv_style_set_pad_row(&style_compact_list, 2); // 保持2px黑色间隙
+    lv_style_set_pad_row(&style_compact_list, ui_h(2)); // 保持2px黑色间隙
     lv_style_set_border_width(&style_compact_list, 0);
 
     // Compact Button Style
@@ -98,7 +186,7 @@ void init_custom_styles() {
     // 这比之前的 12号 更大、更粗、更明显
     lv_style_set_text_font(&style_compact_btn, &lv_font_montserrat_14); 
     
-    lv_style_set_pad_ver(&style_compact_btn, 12); // 高度适中
+    lv_style_set_pad_ver(&style_compact_btn, ui_h(12)); // 高度适中
     lv_style_set_height(&style_compact_btn, LV_SIZE_CONTENT);
     lv_style_set_border_width(&style_compact_btn, 0);
 }
@@ -116,6 +204,80 @@ static char* read_file_to_string(const char* filepath, char* buffer, size_t buff
     return buffer;
 }
 
+static void ensure_cjk_style(void) {
+    if (style_nes_cjk_ready) return;
+    lv_style_init(&style_nes_cjk);
+    lv_style_set_text_font(&style_nes_cjk, &nes_font_16);
+    style_nes_cjk_ready = true;
+}
+
+// --- ROM Directory Cache ---
+// The browsers list regular files from these directories. The listing is read once
+// (on first use or during pre-warm) and only re-read when the directory's mtime changes.
+// The cache owns the names, which are also the launch handlers' user data.
+typedef struct {
+    const char * path;
+    char ** names;
+    uint32_t cnt;
+    time_t mtime;
+    bool loaded;
+    bool ok;   // opendir() succeeded
+} dir_cache_t;
+
+static dir_cache_t nes_dir = {.path = "/oem/nes_games"};
+static dir_cache_t stella_dir = {.path = "/oem/atari_games"};
+
+static void dir_cache_free(dir_cache_t * dc) {
+    for (uint32_t i = 0; i < dc->cnt; i++) free(dc->names[i]);
+    free(dc->names);
+    dc->names = NULL;
+    dc->cnt = 0;
+}
+
+static void dir_cache_load(dir_cache_t * dc) {
+    struct stat st;
+    bool have_stat = stat(dc->path, &st) == 0;
+    if (dc->loaded && have_stat && st.st_mtime == dc->mtime) return;
+
+    dir_cache_free(dc);
+    dc->loaded = true;
+    dc->mtime = have_stat ? st.st_mtime : 0;
+
+    DIR * d = opendir(dc->path);
+    dc->ok = d != NULL;
+    if (!d) return;
+
+    uint32_t cap = 0;
+    struct dirent * dir;
+    while ((dir = readdir(d)) != NULL) {
+        if (dir->d_type != DT_REG) continue;
+        if (dc->cnt == cap) {
+            uint32_t new_cap = cap ? cap * 2 : 16;
+            char ** names = realloc(dc->names, new_cap * sizeof(char *));
+            if (!names) break;
+            dc->names = names;
+            cap = new_cap;
+        }
+        char * name = strdup(dir->d_name);
+        if (name) dc->names[dc->cnt++] = name;
+    }
+    closedir(d);
+}
+
+// Read the listing and run the names through the CJK font once, so its glyph
+// tables are paged in before the browser is first opened
+static void dir_cache_prewarm(dir_cache_t * dc) {
+    if (!dc->loaded) dir_cache_load(dc);
+    lv_point_t size;
+    for (uint32_t i = 0; i < dc->cnt; i++) {
+        lv_txt_get_size(&size, dc->names[i], &nes_font_16, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+    }
+}
+
+static void prewarm_cjk_style(void) { ensure_cjk_style(); }
+static void prewarm_nes_dir(void) { dir_cache_prewarm(&nes_dir); }
+static void prewarm_stella_dir(void) { dir_cache_prewarm(&stella_dir); }
+
 static lv_obj_t* create_styled_list_btn(lv_obj_t * parent, const char * text) {
     lv_obj_t * btn = lv_list_add_btn(parent, NULL, text);
     lv_obj_add_style(btn, &style_compact_btn, 0);
@@ -151,12 +313,12 @@ void create_generic_option_page(const char* title, const char** options, lv_even
     lv_obj_set_style_pad_all(page, 0, 0);
 
     lv_obj_t * list = lv_list_create(page);
-    lv_obj_set_size(list, 280, 200); // Resized for 240p
-    lv_obj_align(list, LV_ALIGN_CENTER, 0, 10); // Center but shifted down slightly for title space if needed
+    lv_obj_set_size(list, ui_w(280), ui_h(200)); // 280x200 at 240p
+    lv_obj_align(list, LV_ALIGN_CENTER, 0, ui_h(10)); // Center but shifted down slightly for title space if needed
     lv_obj_add_style(list, &style_compact_list, 0);
 
     lv_obj_t* title_lbl = lv_list_add_text(list, title);
-    lv_obj_set_style_text_font(title_lbl, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(title_lbl, ui_font(12), 0);
 
     lv_group_t * g = lv_group_get_default();
     for (int i = 0; options[i] != NULL; i++) {
@@ -171,6 +333,11 @@ void create_generic_option_page(const char* title, const char** options, lv_even
 }
 
 // --- Preference Management ---
+// Panel rotations fbdev_rotation_from_degrees() can express
+static bool valid_rotation(long deg) {
+    return deg == 0 || deg == 90 || deg == 180 || deg == 270;
+}
+
 void save_preferences() {
     FILE* fp = fopen(PREFS_FILE, "w");
     if (!fp) {
@@ -179,6 +346,14 @@ void save_preferences() {
     }
     fprintf(fp, "SHOW_SECONDS=%d\n", show_seconds ? 1 : 0);
     fprintf(fp, "IS_24_HOUR=%d\n", is_24_hour_format ? 1 : 0);
+    fprintf(fp, "IDLE_REDUCE_SEC=%u\n", idle_reduce_secs);
+    fprintf(fp, "IDLE_BLANK_SEC=%u\n", idle_blank_secs);
+    fprintf(fp, "RT_PRIORITY=%d\n", rt_priority);
+    fprintf(fp, "RT_CPU_MASK=%u\n", rt_cpu_mask);
+    fprintf(fp, "DRAW_BUF_PCT=%u\n", draw_buf_pct);
+    fprintf(fp, "DRAW_BUF_KB=%u\n", draw_buf_kb);
+    fprintf(fp, "UI_SCALE=%u\n", ui_scale);
+    if (disp_rotation >= 0) fprintf(fp, "DISP_ROTATION=%d\n", disp_rotation);
     fclose(fp);
 }
 
@@ -195,6 +370,14 @@ void load_preferences() {
         if (sscanf(line, "%[^=]=%d", key, &value) == 2) {
             if (strcmp(key, "SHOW_SECONDS") == 0) show_seconds = (value == 1);
             else if (strcmp(key, "IS_24_HOUR") == 0) is_24_hour_format = (value == 1);
+            else if (strcmp(key, "IDLE_REDUCE_SEC") == 0 && value >= 0) idle_reduce_secs = value;
+            else if (strcmp(key, "IDLE_BLANK_SEC") == 0 && value >= 0) idle_blank_secs = value;
+            else if (strcmp(key, "RT_PRIORITY") == 0 && value >= 0) rt_priority = value;
+            else if (strcmp(key, "RT_CPU_MASK") == 0 && value >= 0) rt_cpu_mask = value;
+            else if (strcmp(key, "DRAW_BUF_PCT") == 0 && value > 0 && value <= 100) draw_buf_pct = value;
+            else if (strcmp(key, "DRAW_BUF_KB") == 0 && value >= 0) draw_buf_kb = value;
+            else if (strcmp(key, "UI_SCALE") == 0 && value >= 0) ui_scale = value;
+            else if (strcmp(key, "DISP_ROTATION") == 0 && valid_rotation(value)) disp_rotation = value;
         }
     }
     fclose(fp);
@@ -239,7 +422,7 @@ static void reboot_msgbox_event_handler(lv_event_t * e) {
     lv_obj_t * mbox = lv_event_get_current_target(e);
     if (code == LV_EVENT_VALUE_CHANGED) {
         const char * btn_text = lv_msgbox_get_active_btn_text(mbox);
-        if (btn_text && strcmp(btn_text, "Confirm") == 0) system("reboot");
+        if (btn_text && strcmp(btn_text, "Confirm") == 0) rt_sched_system("reboot");
         else lv_msgbox_close(mbox);
     }
 }
@@ -275,8 +458,8 @@ static void time_value_adjust_event_cb(lv_event_t * e) {
 static void time_save_event_cb(lv_event_t * e) {
     char command[50];
     snprintf(command, sizeof(command), "date -s \"%02d:%02d:00\"", edit_hour, edit_minute);
-    system(command);
-    system("hwclock -w");
+    rt_sched_system(command);
+    rt_sched_system("hwclock -w");
     time_update_task(NULL);
     generic_delete_obj_event_cb(e);
 }
@@ -301,14 +484,37 @@ static void hour_format_event_cb(lv_event_t * e) {
     if(page) lv_obj_del(page);
 }
 
+// Fire just after the boundary, never just before it
+#define CLOCK_ALIGN_SLACK_MS 5
+
 static void time_update_task(lv_timer_t * timer) {
-    time_t t = time(NULL);
-    struct tm *tm_info = localtime(&t);
+    static char shown[12];
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    struct tm tm_info;
+    localtime_r(&now.tv_sec, &tm_info); // Uses the zone cached by tzset() in main()
+
     char time_str[12];
     const char * format_str = is_24_hour_format ? (show_seconds ? "%H:%M:%S" : "%H:%M")
                                                 : (show_seconds ? "%I:%M:%S %p" : "%I:%M %p");
-    strftime(time_str, sizeof(time_str), format_str, tm_info);
-    lv_label_set_text(time_label, time_str);
+    strftime(time_str, sizeof(time_str), format_str, &tm_info);
+    // Only invalidate the label when the visible text changes
+    if (strcmp(time_str, shown) != 0) {
+        strcpy(shown, time_str);
+        clock_sprite_set_text(time_label, time_str);
+    }
+
+    // Sleep until the next second or minute boundary instead of drifting on a 1 s period
+    if (time_timer) {
+        uint32_t ms_into_sec = now.tv_nsec / 1000000;
+        uint32_t delay = 1000 - ms_into_sec;
+        // tm_sec is 60 during a leap second; 59 - 60 would wrap the unsigned delay
+        uint32_t sec = tm_info.tm_sec > 59 ? 59 : tm_info.tm_sec;
+        if (!show_seconds) delay += (59 - sec) * 1000;
+        lv_timer_set_period(time_timer, delay + CLOCK_ALIGN_SLACK_MS);
+        lv_timer_reset(time_timer);
+    }
 }
 
 // --- Menu Handlers ---
@@ -362,7 +568,8 @@ static void time_settings_menu_event_handler(lv_event_t * e) {
 }
 
 static void console_exit_event_handler(lv_event_t * e) {
-    system("/oem/usr/etc/init.d/S98fbterm stop");
+    rt_sched_system("/oem/usr/etc/init.d/S98fbterm stop");
+    rt_sched_resume();
     if(console_screen) { lv_obj_del(console_screen); console_screen = NULL; }
     if(menu_list) {
         lv_obj_clear_flag(menu_list, LV_OBJ_FLAG_HIDDEN);
@@ -386,15 +593,15 @@ void create_console_screen(lv_obj_t * parent) {
     lv_obj_set_style_bg_opa(console_screen, LV_OPA_COVER, 0);
 
     lv_obj_t * exit_btn = lv_btn_create(console_screen);
-    lv_obj_align(exit_btn, LV_ALIGN_BOTTOM_MID, 0, -5); // Tighter bottom margin
+    lv_obj_align(exit_btn, LV_ALIGN_BOTTOM_MID, 0, ui_h(-5)); // Tighter bottom margin
     lv_obj_add_event_cb(exit_btn, console_exit_event_handler, LV_EVENT_CLICKED, NULL);
     lv_obj_set_style_bg_color(exit_btn, lv_color_hex(0x404040), LV_STATE_DEFAULT);
     lv_obj_set_style_bg_color(exit_btn, lv_color_hex(0x5070a0), LV_STATE_FOCUSED);
-    lv_obj_set_height(exit_btn, 24); // Smaller button
+    lv_obj_set_height(exit_btn, ui_h(24)); // Smaller button
 
     lv_obj_t * exit_label = lv_label_create(exit_btn);
     lv_label_set_text(exit_label, "Exit");
-    lv_obj_set_style_text_font(exit_label, &lv_font_montserrat_12, 0); // Smaller font
+    lv_obj_set_style_text_font(exit_label, ui_font(12), 0); // Smaller font
     lv_obj_center(exit_label);
     lv_obj_set_style_text_color(exit_label, lv_color_hex(0xffffff), 0);
 
@@ -404,6 +611,8 @@ void create_console_screen(lv_obj_t * parent) {
     
     lv_timer_handler();
     usleep(16000);
+    // fbterm owns the screen until "Exit"; don't compete with it at RT priority
+    rt_sched_suspend();
     system("/oem/usr/etc/init.d/S98fbterm start_with_input &");
 }
 
@@ -417,6 +626,7 @@ void create_game_screen(lv_obj_t * parent) {
     lv_obj_set_style_bg_opa(console_screen, LV_OPA_COVER, 0);
     lv_timer_handler();
     usleep(16000);
+    rt_sched_suspend();
     system("/oem/lv_execute/term_start_all.sh < /dev/null &");
 }
 
@@ -425,13 +635,13 @@ void create_reboot_msgbox() {
     static const char * btns[] = {"Confirm", ""};
     
     lv_obj_t * mbox = lv_msgbox_create(lv_scr_act(), "Reboot", "Reboot system?", btns, true);
-    lv_obj_set_width(mbox, 260); // Limit width for 240p
+    lv_obj_set_width(mbox, ui_w(260)); // Limit width (260 at 240p)
     lv_obj_add_event_cb(mbox, reboot_msgbox_event_handler, LV_EVENT_VALUE_CHANGED, NULL);
     lv_obj_add_event_cb(mbox, modal_close_event_cb, LV_EVENT_DELETE, NULL);
     lv_obj_center(mbox);
 
     lv_obj_set_style_bg_color(mbox, lv_color_hex(0x2d2d2d), 0);
-    lv_obj_set_style_text_font(mbox, &lv_font_montserrat_12, 0); // Consistent font
+    lv_obj_set_style_text_font(mbox, ui_font(12), 0); // Consistent font
     lv_obj_set_style_text_color(lv_msgbox_get_title(mbox), lv_color_hex(0xFFFFFF), 0);
     lv_obj_set_style_text_color(lv_msgbox_get_text(mbox), lv_color_hex(0xffffff), 0);
     
@@ -455,7 +665,7 @@ void create_about_screen(lv_obj_t * parent) {
     lv_obj_set_size(about_screen, LV_HOR_RES, LV_VER_RES);
     lv_obj_set_style_bg_color(about_screen, lv_color_hex(0x1e1e1e), 0);
     lv_obj_set_style_border_width(about_screen, 0, 0);
-    lv_obj_set_style_pad_all(about_screen, 5, 0);
+    lv_obj_set_style_pad_all(about_screen, ui_h(5), 0);
 
     char buffer[512];
     long mem_total = 0, mem_available = 0;
@@ -479,18 +689,18 @@ void create_about_screen(lv_obj_t * parent) {
     lv_obj_t * about_label = lv_label_create(about_screen);
     lv_label_set_text(about_label, buffer);
     lv_obj_set_style_text_color(about_label, lv_color_hex(0xe0e0e0), 0);
-    lv_obj_set_style_text_font(about_label, &lv_font_montserrat_12, 0); // Small font
-    lv_obj_set_width(about_label, 280); // Ensure wrapping
-    lv_obj_align(about_label, LV_ALIGN_TOP_LEFT, 10, 20);
+    lv_obj_set_style_text_font(about_label, ui_font(12), 0); // Small font
+    lv_obj_set_width(about_label, ui_w(280)); // Ensure wrapping
+    lv_obj_align(about_label, LV_ALIGN_TOP_LEFT, ui_w(10), ui_h(20));
 
     lv_obj_t * back_btn = lv_btn_create(about_screen);
-    lv_obj_set_height(back_btn, 24);
-    lv_obj_align(back_btn, LV_ALIGN_BOTTOM_MID, 0, -5);
+    lv_obj_set_height(back_btn, ui_h(24));
+    lv_obj_align(back_btn, LV_ALIGN_BOTTOM_MID, 0, ui_h(-5));
     lv_obj_add_event_cb(back_btn, about_screen_back_btn_event_handler, LV_EVENT_CLICKED, NULL);
 
     lv_obj_t * back_label = lv_label_create(back_btn);
     lv_label_set_text(back_label, "Back");
-    lv_obj_set_style_text_font(back_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(back_label, ui_font(12), 0);
     lv_obj_center(back_label);
 
     lv_group_add_obj(lv_group_get_default(), back_btn);
@@ -499,9 +709,9 @@ void create_about_screen(lv_obj_t * parent) {
 
 void create_main_menu(lv_obj_t * parent, lv_group_t * g) {
     menu_list = lv_list_create(parent);
-    // 280x200 to fit under the clock and inside screen
-    lv_obj_set_size(menu_list, 280, 200);
-    lv_obj_align(menu_list, LV_ALIGN_BOTTOM_MID, 0, -5);
+    // 280x200 at 240p to fit under the clock and inside screen
+    lv_obj_set_size(menu_list, ui_w(280), ui_h(200));
+    lv_obj_align(menu_list, LV_ALIGN_BOTTOM_MID, 0, ui_h(-5));
     lv_obj_add_style(menu_list, &style_compact_list, 0);
 
     const char * menu_items[] = {"Meow RPG", "NES Emulator", "Stella", "Console", "Settings", "About", "Reboot"};
@@ -532,22 +742,23 @@ void create_time_setter_page() {
     lv_obj_set_style_pad_all(page, 0, 0);
 
     time_t t = time(NULL);
-    struct tm *tm_info = localtime(&t);
-    edit_hour = tm_info->tm_hour;
-    edit_minute = tm_info->tm_min;
+    struct tm tm_info;
+    localtime_r(&t, &tm_info);
+    edit_hour = tm_info.tm_hour;
+    edit_minute = tm_info.tm_min;
 
     lv_obj_t* container = lv_obj_create(page);
     lv_obj_center(container);
-    lv_obj_set_size(container, 280, 140); // Compact container
+    lv_obj_set_size(container, ui_w(280), ui_h(140)); // Compact container
     lv_obj_set_style_bg_opa(container, LV_OPA_TRANSP, 0);
     lv_obj_set_style_border_width(container, 0, 0);
     lv_obj_set_flex_flow(container, LV_FLEX_FLOW_ROW);
     lv_obj_set_flex_align(container, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    lv_obj_set_style_pad_column(container, 10, 0);
+    lv_obj_set_style_pad_column(container, ui_w(10), 0);
 
     // Hour Box
     lv_obj_t * hour_obj = lv_obj_create(container);
-    lv_obj_set_size(hour_obj, 80, 70);
+    lv_obj_set_size(hour_obj, ui_w(80), ui_h(70));
     lv_obj_set_style_bg_color(hour_obj, lv_color_hex(0x404040), 0);
     lv_obj_set_style_bg_color(hour_obj, lv_color_hex(0x5070a0), LV_STATE_FOCUSED);
     lv_obj_set_scrollbar_mode(hour_obj, LV_SCROLLBAR_MODE_OFF);
@@ -555,19 +766,19 @@ void create_time_setter_page() {
 
     time_setter_hour_label = lv_label_create(hour_obj);
     lv_label_set_text_fmt(time_setter_hour_label, "%02d", edit_hour);
-    lv_obj_set_style_text_font(time_setter_hour_label, &lv_font_montserrat_36, 0); // Requested size
+    lv_obj_set_style_text_font(time_setter_hour_label, ui_font(36), 0); // Requested size
     lv_obj_set_style_text_color(time_setter_hour_label, lv_color_white(), 0);
     lv_obj_center(time_setter_hour_label);
     lv_obj_add_event_cb(hour_obj, time_value_adjust_event_cb, LV_EVENT_KEY, time_setter_hour_label);
 
     lv_obj_t* sep_label = lv_label_create(container);
     lv_label_set_text(sep_label, ":");
-    lv_obj_set_style_text_font(sep_label, &lv_font_montserrat_36, 0);
+    lv_obj_set_style_text_font(sep_label, ui_font(36), 0);
     lv_obj_set_style_text_color(sep_label, lv_color_white(), 0);
 
     // Minute Box
     lv_obj_t * minute_obj = lv_obj_create(container);
-    lv_obj_set_size(minute_obj, 80, 70);
+    lv_obj_set_size(minute_obj, ui_w(80), ui_h(70));
     lv_obj_set_style_bg_color(minute_obj, lv_color_hex(0x404040), 0);
     lv_obj_set_style_bg_color(minute_obj, lv_color_hex(0x5070a0), LV_STATE_FOCUSED);
     lv_obj_set_scrollbar_mode(minute_obj, LV_SCROLLBAR_MODE_OFF);
@@ -575,25 +786,25 @@ void create_time_setter_page() {
 
     time_setter_minute_label = lv_label_create(minute_obj);
     lv_label_set_text_fmt(time_setter_minute_label, "%02d", edit_minute);
-    lv_obj_set_style_text_font(time_setter_minute_label, &lv_font_montserrat_36, 0); // Requested size
+    lv_obj_set_style_text_font(time_setter_minute_label, ui_font(36), 0); // Requested size
     lv_obj_set_style_text_color(time_setter_minute_label, lv_color_white(), 0);
     lv_obj_center(time_setter_minute_label);
     lv_obj_add_event_cb(minute_obj, time_value_adjust_event_cb, LV_EVENT_KEY, time_setter_minute_label);
 
     lv_obj_t* save_btn = lv_btn_create(page);
-    lv_obj_set_height(save_btn, 30);
-    lv_obj_align(save_btn, LV_ALIGN_BOTTOM_LEFT, 20, -10);
+    lv_obj_set_height(save_btn, ui_h(30));
+    lv_obj_align(save_btn, LV_ALIGN_BOTTOM_LEFT, ui_w(20), ui_h(-10));
     lv_obj_t* save_label = lv_label_create(save_btn);
     lv_label_set_text(save_label, "Save");
-    lv_obj_set_style_text_font(save_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(save_label, ui_font(12), 0);
     lv_obj_add_event_cb(save_btn, time_save_event_cb, LV_EVENT_CLICKED, page);
 
     lv_obj_t* back_btn = lv_btn_create(page);
-    lv_obj_set_height(back_btn, 30);
-    lv_obj_align(back_btn, LV_ALIGN_BOTTOM_RIGHT, -20, -10);
+    lv_obj_set_height(back_btn, ui_h(30));
+    lv_obj_align(back_btn, LV_ALIGN_BOTTOM_RIGHT, ui_w(-20), ui_h(-10));
     lv_obj_t* back_label = lv_label_create(back_btn);
     lv_label_set_text(back_label, "Back");
-    lv_obj_set_style_text_font(back_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(back_label, ui_font(12), 0);
     lv_obj_add_event_cb(back_btn, generic_delete_obj_event_cb, LV_EVENT_CLICKED, page);
 
     lv_group_t* g = lv_group_get_default();
@@ -606,8 +817,8 @@ void create_time_setter_page() {
 
 void create_time_settings_screen() {
     time_settings_screen = lv_list_create(lv_scr_act());
-    lv_obj_set_size(time_settings_screen, 280, 190);
-    lv_obj_align(time_settings_screen, LV_ALIGN_CENTER, 0, 10);
+    lv_obj_set_size(time_settings_screen, ui_w(280), ui_h(190));
+    lv_obj_align(time_settings_screen, LV_ALIGN_CENTER, 0, ui_h(10));
     lv_obj_add_event_cb(time_settings_screen, time_settings_screen_close_cb, LV_EVENT_DELETE, NULL);
     lv_obj_add_style(time_settings_screen, &style_compact_list, 0);
 
@@ -622,8 +833,8 @@ void create_time_settings_screen() {
 
 void create_settings_screen(lv_obj_t * parent) {
     settings_screen = lv_list_create(parent);
-    lv_obj_set_size(settings_screen, 280, 190);
-    lv_obj_align(settings_screen, LV_ALIGN_CENTER, 0, 10);
+    lv_obj_set_size(settings_screen, ui_w(280), ui_h(190));
+    lv_obj_align(settings_screen, LV_ALIGN_CENTER, 0, ui_h(10));
     lv_obj_add_event_cb(settings_screen, settings_screen_close_cb, LV_EVENT_DELETE, NULL);
     lv_obj_add_style(settings_screen, &style_compact_list, 0);
 
@@ -672,6 +883,7 @@ static void nes_game_launch_event_handler(lv_event_t * e) {
 
     lv_timer_handler();
     usleep(16000); 
+    rt_sched_suspend();
     system(command);
 }
 
@@ -694,16 +906,20 @@ static void stella_game_launch_event_handler(lv_event_t * e) {
 
     lv_timer_handler();
     usleep(16000); 
+    rt_sched_suspend();
     system(command);
 }
 
 void create_nes_browser_screen(lv_obj_t * parent) {
+    ensure_cjk_style();
+    dir_cache_load(&nes_dir);
+
     nes_browser_screen = lv_list_create(parent);
     lv_obj_add_style(nes_browser_screen, &style_nes_cjk, 0);    
     lv_obj_add_style(nes_browser_screen, &style_compact_list, 0);
 
-    lv_obj_set_size(nes_browser_screen, 280, 190);
-    lv_obj_align(nes_browser_screen, LV_ALIGN_CENTER, 0, 10);
+    lv_obj_set_size(nes_browser_screen, ui_w(280), ui_h(190));
+    lv_obj_align(nes_browser_screen, LV_ALIGN_CENTER, 0, ui_h(10));
     lv_obj_add_event_cb(nes_browser_screen, nes_browser_screen_close_cb, LV_EVENT_DELETE, NULL);
 
     lv_group_t * g = lv_group_get_default();
@@ -712,22 +928,12 @@ void create_nes_browser_screen(lv_obj_t * parent) {
     lv_obj_add_event_cb(btn_back, generic_delete_obj_event_cb, LV_EVENT_CLICKED, nes_browser_screen);
     lv_group_add_obj(g, btn_back);
 
-    const char * dir_path = "/oem/nes_games";
-    DIR *d;
-    struct dirent *dir;
-    d = opendir(dir_path);
-    if (d) {
-        while ((dir = readdir(d)) != NULL) {
-            if (dir->d_type == DT_REG) {
-                char* filename_copy = strdup(dir->d_name);
-                if (filename_copy) {
-                    lv_obj_t * btn_game = create_styled_list_btn(nes_browser_screen, filename_copy);
-                    lv_obj_add_event_cb(btn_game, nes_game_launch_event_handler, LV_EVENT_CLICKED, filename_copy);
-                    lv_group_add_obj(g, btn_game);
-                }
-            }
+    if (nes_dir.ok) {
+        for (uint32_t i = 0; i < nes_dir.cnt; i++) {
+            lv_obj_t * btn_game = create_styled_list_btn(nes_browser_screen, nes_dir.names[i]);
+            lv_obj_add_event_cb(btn_game, nes_game_launch_event_handler, LV_EVENT_CLICKED, nes_dir.names[i]);
+            lv_group_add_obj(g, btn_game);
         }
-        closedir(d);
     } else {
         lv_list_add_text(nes_browser_screen, "Error: Cannot open dir");
     }
@@ -735,12 +941,15 @@ void create_nes_browser_screen(lv_obj_t * parent) {
 } 
 
 void create_stella_browser_screen(lv_obj_t * parent) {
+    ensure_cjk_style();
+    dir_cache_load(&stella_dir);
+
     stella_browser_screen = lv_list_create(parent);
     lv_obj_add_style(stella_browser_screen, &style_nes_cjk, 0);    
     lv_obj_add_style(stella_browser_screen, &style_compact_list, 0);
 
-    lv_obj_set_size(stella_browser_screen, 280, 190);
-    lv_obj_align(stella_browser_screen, LV_ALIGN_CENTER, 0, 10);
+    lv_obj_set_size(stella_browser_screen, ui_w(280), ui_h(190));
+    lv_obj_align(stella_browser_screen, LV_ALIGN_CENTER, 0, ui_h(10));
     lv_obj_add_event_cb(stella_browser_screen, stella_browser_screen_close_cb, LV_EVENT_DELETE, NULL);
 
     lv_group_t * g = lv_group_get_default();
@@ -749,55 +958,357 @@ void create_stella_browser_screen(lv_obj_t * parent) {
     lv_obj_add_event_cb(btn_back, generic_delete_obj_event_cb, LV_EVENT_CLICKED, stella_browser_screen);
     lv_group_add_obj(g, btn_back);
 
-    const char * dir_path = "/oem/atari_games";
-    DIR *d;
-    struct dirent *dir;
-    d = opendir(dir_path);
-    if (d) {
-        while ((dir = readdir(d)) != NULL) {
-            if (dir->d_type == DT_REG) {
-                char* filename_copy = strdup(dir->d_name);
-                if (filename_copy) {
-                    lv_obj_t * btn_game = create_styled_list_btn(stella_browser_screen, filename_copy);
-                    lv_obj_add_event_cb(btn_game, stella_game_launch_event_handler, LV_EVENT_CLICKED, filename_copy);
-                    lv_group_add_obj(g, btn_game);
-                }
-            }
+    if (stella_dir.ok) {
+        for (uint32_t i = 0; i < stella_dir.cnt; i++) {
+            lv_obj_t * btn_game = create_styled_list_btn(stella_browser_screen, stella_dir.names[i]);
+            lv_obj_add_event_cb(btn_game, stella_game_launch_event_handler, LV_EVENT_CLICKED, stella_dir.names[i]);
+            lv_group_add_obj(g, btn_game);
         }
-        closedir(d);
     } else {
         lv_list_add_text(stella_browser_screen, "Error: Cannot open dir");
     }
     lv_group_focus_obj(btn_back);
 } 
 
-// --- Main Application Entry ---
-int main(void)
-{
-    lv_init();
-    
-    // Init Styles first
-    init_custom_styles();
+// --- Event Loop Glue ---
+// Key events normally come from the input thread's ring; if the thread can't be
+// started the keypad falls back to reading the evdev fd directly.
+static bool use_input_thread;
+
+// The keypad read timer only runs while a key is held (for LVGL's long-press repeat).
+// Once the key is released it is paused and re-armed when new input is signalled.
+static void keypad_read_cb(lv_indev_drv_t * drv, lv_indev_data_t * data) {
+    if (use_input_thread) input_thread_read(drv, data);
+    else evdev_read(drv, data);
+    if (data->state == LV_INDEV_STATE_REL && !data->continue_reading) {
+        lv_timer_pause(drv->read_timer);
+    }
+}
 
-    // Init the font for CJK
-    lv_style_init(&style_nes_cjk);
-    lv_style_set_text_font(&style_nes_cjk, &nes_font_16);
+static void keypad_wake(lv_indev_t * indev) {
+    lv_timer_resume(indev->driver->read_timer);
+    lv_timer_ready(indev->driver->read_timer);
+}
+
+static void keypad_fd_ready_cb(int fd, uint32_t events, void * user_data) {
+    // The key press that wakes a blanked panel is not a navigation event
+    if (idle_power_input_ready(fd)) return;
+    keypad_wake(user_data);
+}
+
+// Wake-up key swallowing happens in the read_cb through idle_power_filter_key()
+static void input_thread_ready_cb(int fd, uint32_t events, void * user_data) {
+    input_thread_ack();
+    keypad_wake(user_data);
+}
+
+static void ui_queue_ready_cb(int fd, uint32_t events, void * user_data) {
+    ui_queue_drain(UI_QUEUE_BUDGET_US);
+}
+
+static void stats_signal_cb(int fd, uint32_t events, void * user_data) {
+    struct signalfd_siginfo si;
+    while (read(fd, &si, sizeof(si)) == sizeof(si)) {}
+    event_loop_dump_stats(stderr);
+    frame_sched_dump_stats(stderr);
+    idle_power_dump_stats(stderr);
+    rt_sched_dump_stats(stderr);
+    watchdog_dump_stats(stderr);
+    input_thread_dump_stats(stderr);
+    ui_queue_dump_stats(stderr);
+    flush_worker_dump_stats(stderr);
+    area_coalesce_dump_stats(stderr);
+    boot_splash_dump_stats(stderr);
+    startup_dump_timeline(stderr);
+
+    fbdev_stats_t fs;
+    fbdev_get_stats(&fs);
+    fprintf(stderr, "[fbdev] %u frames, %u flushes, %llu KiB copied, page flip %s (%u flips, %u vsync waits, %llu KiB synced)\n",
+            fs.frames, fs.flushes, (unsigned long long)(fs.copy_bytes / 1024),
+            fbdev_is_page_flipping() ? "on" : "off", fs.flips, fs.vsync_waits,
+            (unsigned long long)(fs.sync_bytes / 1024));
+    fprintf(stderr, "[fbdev] %llu KiB written to the framebuffer (%.0f%% of copied), last frame %u of %u bytes, %u areas dropped\n",
+            (unsigned long long)(fs.write_bytes / 1024), fs.copy_bytes ? 100.0 * fs.write_bytes / fs.copy_bytes : 0.0,
+            fs.last_frame_write_bytes, fs.last_frame_copy_bytes, fs.dropped);
+
+    tick_stats_t ts;
+    tick_get_stats(&ts);
+    fprintf(stderr, "[tick] overruns %llu (last %u ms, max gap %u ms), wall-clock jumps %llu (%+lld ms total)\n",
+            (unsigned long long)ts.overruns, ts.last_gap_ms, ts.max_gap_ms,
+            (unsigned long long)ts.wall_jumps, (long long)ts.wall_jump_ms);
+}
 
-    load_preferences(); 
+static void disp_flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p) {
+    startup_mark(STARTUP_FIRST_FLUSH);
+    if (flush_worker_is_running()) flush_worker_submit(drv, area, color_p);
+    else fbdev_flush(drv, area, color_p);
+}
+
+static void disp_monitor_cb(lv_disp_drv_t * drv, uint32_t time_ms, uint32_t px) {
+    // The boot splash captures the first frame from the framebuffer: let its last strip land
+    static bool first_frame = true;
+    if (first_frame && flush_worker_is_running()) flush_worker_wait(drv);
+    first_frame = false;
+
+    startup_mark(STARTUP_FIRST_FRAME);
+    boot_splash_frame_done(px, (uint32_t)drv->hor_res * drv->ver_res);
+}
+
+// Nobody sees the clock while the panel is blanked
+static void idle_power_state_changed(idle_power_state_t state) {
+    if (!time_timer) return;
+    if (state == IDLE_POWER_BLANKED) {
+        lv_timer_pause(time_timer);
+    } else {
+        lv_timer_resume(time_timer);
+        time_update_task(NULL);
+    }
+}
 
+// SIGTERM / SIGINT: give the framebuffer back in its original mode, then die as usual.
+// A plain handler rather than the signalfd, so programs started with system() keep default handling.
+// Only installed when --fb-mode switched the mode; fbdev_restore_mode() is a bare ioctl, safe here.
+static void exit_signal_handler(int sig) {
+    fbdev_restore_mode();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void setup_exit_signals(void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = exit_signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+}
+
+// SIGUSR1 dumps runtime statistics to stderr (`kill -USR1 $(pidof pico-menu)`)
+static void setup_stats_signal(void) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+
+    int sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (sfd < 0) {
+        perror("signalfd");
+        return;
+    }
+    event_loop_add_fd(sfd, EPOLLIN, stats_signal_cb, NULL);
+}
+
+// --- Display Geometry ---
+// Lines per draw buffer: draw_buf_pct of the screen, capped by the draw_buf_kb budget
+// (either one replaced by --draw-buf)
+static uint32_t draw_buf_lines(uint32_t hor_res, uint32_t ver_res, uint32_t buf_cnt) {
+    uint32_t pct = arg_draw_buf_pct ? arg_draw_buf_pct : draw_buf_pct;
+    uint32_t kb = arg_draw_buf_kb ? arg_draw_buf_kb : draw_buf_kb;
+    uint32_t lines = ver_res * pct / 100;
+    if (kb) {
+        uint32_t budget = kb * 1024 / (buf_cnt * hor_res * sizeof(lv_color_t));
+        if (lines > budget) lines = budget;
+    }
+    if (lines < 1) lines = 1;
+    if (lines > ver_res) lines = ver_res;
+    return lines;
+}
+
+// --- Command Line ---
+static void print_usage(const char * prog) {
+    fprintf(stderr, "Usage: %s [--rt[=PRIO]] [--cpus=LIST] [--watchdog=MS,MS,...] [--eager] [--sync-flush] [--shadow-fb]\n"
+                    "          [--draw-buf=PCT%%|KIBk] [--scale=N] [--rotate=DEG] [--fb-mode]\n"
+                    "          [--fb-file=SPEC] [--coalesce=PX] [--selftest]\n"
+                    "  --rt[=PRIO]   run the UI thread as SCHED_FIFO (default priority %d)\n"
+                    "  --cpus=LIST   pin the UI thread in RT mode, e.g. 0 or 0-1\n"
+                    "  --watchdog=   main loop stall thresholds in ms (default 50,250,1000)\n"
+                    "  --eager       build everything before the first frame instead of on idle\n"
+                    "  --sync-flush  copy to the framebuffer on the UI thread (no flush worker)\n"
+                    "  --shadow-fb   only write pixels that changed (for SPI / fbtft displays)\n"
+                    "  --draw-buf=   draw buffer size as %% of the screen (default %d%%) or total KiB budget\n"
+                    "  --scale=N     upscale the %dx%d UI by N on larger screens (0 = auto, 1 = off)\n"
+                    "  --rotate=DEG  rotate the picture clockwise on the panel: 0, 90, 180 or 270\n"
+                    "  --fb-mode     switch the framebuffer to the UI's colour depth and two pages\n"
+                    "  --fb-file=    draw into a plain file (e.g. in /dev/shm) instead of %s, SPEC is\n"
+                    "                PATH,WxH,BPP[,stride=BYTES][,xoffset=N][,yoffset=N][,bgr]\n"
+                    "  --coalesce=PX merge invalidated areas when it saves more than PX pixels of work\n"
+                    "                per area (default %u, 0 = off)\n"
+                    "  --selftest    check the framebuffer pixel converters and exit\n",
+            prog, RT_SCHED_DEFAULT_PRIORITY, DRAW_BUF_DEFAULT_PCT, UI_REF_HOR_RES, UI_REF_VER_RES,
+            FBDEV_PATH, AREA_COALESCE_DEFAULT_CALL_COST_PX);
+}
+
+// Command line options override the preferences file
+static bool parse_args(int argc, char ** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rt") == 0) {
+            arg_rt_priority = RT_SCHED_DEFAULT_PRIORITY;
+        } else if (strncmp(argv[i], "--rt=", 5) == 0) {
+            arg_rt_priority = atoi(argv[i] + 5);
+            if (arg_rt_priority < 0) arg_rt_priority = 0;
+        } else if (strncmp(argv[i], "--cpus=", 7) == 0) {
+            arg_rt_cpu_mask = rt_sched_parse_cpus(argv[i] + 7);
+            if (!arg_rt_cpu_mask) {
+                fprintf(stderr, "Invalid CPU list: %s\n", argv[i] + 7);
+                return false;
+            }
+        } else if (strncmp(argv[i], "--watchdog=", 11) == 0) {
+            watchdog_threshold_cnt = watchdog_parse_thresholds(argv[i] + 11, watchdog_thresholds, WATCHDOG_MAX_THRESHOLDS);
+            if (!watchdog_threshold_cnt) {
+                fprintf(stderr, "Invalid watchdog thresholds: %s\n", argv[i] + 11);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--eager") == 0) {
+            eager_init = true;
+        } else if (strcmp(argv[i], "--sync-flush") == 0) {
+            sync_flush = true;
+        } else if (strcmp(argv[i], "--shadow-fb") == 0) {
+            shadow_fb = true;
+        } else if (strncmp(argv[i], "--rotate=", 9) == 0) {
+            char * end;
+            long v = strtol(argv[i] + 9, &end, 10);
+            if (end == argv[i] + 9 || *end != '\0' || !valid_rotation(v)) {
+                fprintf(stderr, "Invalid rotation: %s\n", argv[i] + 9);
+                return false;
+            }
+            arg_disp_rotation = v;
+        } else if (strncmp(argv[i], "--fb-file=", 10) == 0) {
+            if (!fbdev_file_parse(argv[i] + 10, &fb_file)) {
+                fprintf(stderr, "Invalid framebuffer file: %s\n", argv[i] + 10);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--fb-mode") == 0) {
+            fb_negotiate = true;
+        } else if (strncmp(argv[i], "--coalesce=", 11) == 0) {
+            char * end;
+            long v = strtol(argv[i] + 11, &end, 10);
+            if (end == argv[i] + 11 || *end != '\0' || v < 0 || v > 1000000) {
+                fprintf(stderr, "Invalid coalesce cost: %s\n", argv[i] + 11);
+                return false;
+            }
+            coalesce_cost_px = v;
+        } else if (strncmp(argv[i], "--scale=", 8) == 0) {
+            char * end;
+            long v = strtol(argv[i] + 8, &end, 10);
+            if (end == argv[i] + 8 || *end != '\0' || v < 0 || v > 100) {
+                fprintf(stderr, "Invalid scale: %s\n", argv[i] + 8);
+                return false;
+            }
+            arg_ui_scale = v;
+        } else if (strncmp(argv[i], "--draw-buf=", 11) == 0) {
+            char * end;
+            long v = strtol(argv[i] + 11, &end, 10);
+            if (v > 0 && v <= 100 && strcmp(end, "%") == 0) arg_draw_buf_pct = v;
+            else if (v > 0 && (strcmp(end, "k") == 0 || strcmp(end, "K") == 0)) arg_draw_buf_kb = v;
+            else {
+                fprintf(stderr, "Invalid draw buffer size: %s\n", argv[i] + 11);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--selftest") == 0) {
+            run_selftest = true;
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Main Application Entry ---
+int main(int argc, char ** argv)
+{
+    boot_splash_mark_start();
+    startup_mark(STARTUP_MAIN);
+    load_preferences();
+    if (!parse_args(argc, argv)) return 1;
+    if (run_selftest) {
+        int failed = fbdev_pixconv_selftest();
+        fprintf(stderr, "pixel converter selftest: %s\n", failed ? "FAILED" : "ok");
+        return failed ? 1 : 0;
+    }
+
+    // Put the cached main menu on screen before any LVGL work; the first live frame replaces it
+    if (shadow_fb) fbdev_set_shadow(true);
+    if (fb_negotiate) fbdev_set_negotiate(true);
+    if (fb_file.path[0]) fbdev_set_file(&fb_file);
+    int rotation = arg_disp_rotation >= 0 ? arg_disp_rotation : disp_rotation;
+    if (rotation >= 0) fbdev_set_rotation(fbdev_rotation_from_degrees(rotation));
     fbdev_init();
+    if (fbdev_mode_changed()) setup_exit_signals();
+    boot_splash_show(PREFS_FILE);
+
+    lv_init();
+    startup_mark(STARTUP_LV_INIT);
+
+    // One binary serves 240x240, 320x240 and 480x320 panels: take the geometry from the framebuffer
+    uint32_t hor_res, ver_res;
+    fbdev_get_sizes(&hor_res, &ver_res);
+    if (!hor_res || !ver_res) {
+        hor_res = UI_REF_HOR_RES;
+        ver_res = UI_REF_VER_RES;
+    }
+    // A panel mounted sideways: LVGL sees the screen with width and height exchanged
+    fbdev_rotation_t rot = fbdev_get_rotation();
+    if (rot == FBDEV_ROT_90 || rot == FBDEV_ROT_270) {
+        uint32_t tmp = hor_res;
+        hor_res = ver_res;
+        ver_res = tmp;
+    }
+    // HDMI framebuffers (640x480, 1280x720) would cost 4-9x the fill rate at native resolution:
+    // render the reference layout and let the flush replicate pixels
+    uint32_t scale = fbdev_set_scale(UI_REF_HOR_RES, UI_REF_VER_RES,
+                                     arg_ui_scale >= 0 ? (uint32_t)arg_ui_scale : ui_scale);
+    if (scale > 1) {
+        fprintf(stderr, "[display] %ux%u screen, UI upscaled %ux from %dx%d\n", hor_res, ver_res, scale,
+                UI_REF_HOR_RES, UI_REF_VER_RES);
+        hor_res = UI_REF_HOR_RES;
+        ver_res = UI_REF_VER_RES;
+    }
 
-    static lv_color_t buf[DISP_BUF_SIZE];
+    // Render straight into the framebuffer when its format allows it (no per-pixel copy),
+    // otherwise into strip buffers that fbdev_flush() copies out. With two strip buffers the
+    // copy runs on the flush worker while LVGL renders the next strip.
     static lv_disp_draw_buf_t disp_buf;
-    lv_disp_draw_buf_init(&disp_buf, buf, NULL, DISP_BUF_SIZE);
+    void * fb_buf1, * fb_buf2;
+    bool direct = fbdev_direct_init(hor_res, ver_res, &fb_buf1, &fb_buf2);
+    if (direct) {
+        lv_disp_draw_buf_init(&disp_buf, fb_buf1, fb_buf2, hor_res * ver_res);
+    } else {
+        bool two = !sync_flush && flush_worker_start(fbdev_flush);
+        uint32_t buf_px = hor_res * draw_buf_lines(hor_res, ver_res, two ? 2 : 1);
+        lv_color_t * buf = malloc(buf_px * sizeof(lv_color_t));
+        lv_color_t * buf2 = two ? malloc(buf_px * sizeof(lv_color_t)) : NULL;
+        if (!buf || (two && !buf2)) {
+            fprintf(stderr, "Failed to allocate %u byte draw buffers\n", (unsigned)(buf_px * sizeof(lv_color_t)));
+            return 1;
+        }
+        lv_disp_draw_buf_init(&disp_buf, buf, buf2, buf_px);
+        fprintf(stderr, "[display] %ux%u, %s draw buffer%s of %u lines\n", hor_res, ver_res, two ? "two" : "one",
+                two ? "s" : "", buf_px / hor_res);
+    }
+    // Shadow and rotation buffer are allocated here: with the worker, fbdev_flush() runs off the UI thread
+    fbdev_prepare(disp_buf.size);
 
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
     disp_drv.draw_buf  = &disp_buf;
-    disp_drv.flush_cb  = fbdev_flush;
-    disp_drv.hor_res   = 320;
-    disp_drv.ver_res   = 240;
-    lv_disp_drv_register(&disp_drv);
+    disp_drv.flush_cb  = disp_flush_cb;
+    disp_drv.hor_res   = hor_res;
+    disp_drv.ver_res   = ver_res;
+    disp_drv.monitor_cb = disp_monitor_cb;
+    disp_drv.direct_mode = direct;
+    if (flush_worker_is_running()) {
+        disp_drv.wait_cb = flush_worker_wait;
+        rt_sched_add_thread(flush_worker_get_thread());
+    }
+    lv_disp_t * disp = lv_disp_drv_register(&disp_drv);
+    area_coalesce_init(disp, coalesce_cost_px);
+
+    // Styles once the display exists: their sizes follow its resolution
+    // (only those the main menu needs; the CJK style is built lazily)
+    init_custom_styles();
+    fprintf(stderr, "[display] %ux%u, %ubpp framebuffer, pipeline %s, page flip %s\n", hor_res, ver_res,
+            fbdev_get_bpp(), fbdev_get_pipeline(), fbdev_is_page_flipping() ? "on" : "off");
     
     evdev_init();
     evdev_set_file(EVDEV_PATH);
@@ -805,9 +1316,29 @@ int main(void)
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv);
     indev_drv.type = LV_INDEV_TYPE_KEYPAD;
-    indev_drv.read_cb = evdev_read;
+    indev_drv.read_cb = keypad_read_cb;
     lv_indev_t * keypad_indev = lv_indev_drv_register(&indev_drv);
 
+    if (!event_loop_init()) {
+        fprintf(stderr, "Failed to set up the event loop\n");
+        return 1;
+    }
+    // Block SIGUSR1 before any thread exists so all threads inherit the mask
+    setup_stats_signal();
+
+    if (ui_queue_init()) {
+        event_loop_add_fd(ui_queue_get_wake_fd(), EPOLLIN, ui_queue_ready_cb, NULL);
+    }
+
+    use_input_thread = input_thread_start(evdev_get_fd());
+    if (use_input_thread) {
+        rt_sched_add_thread(input_thread_get_thread());
+        input_thread_set_filter(idle_power_filter_key);
+        event_loop_add_fd(input_thread_get_wake_fd(), EPOLLIN, input_thread_ready_cb, keypad_indev);
+    } else {
+        event_loop_add_fd(evdev_get_fd(), EPOLLIN, keypad_fd_ready_cb, keypad_indev);
+    }
+
     lv_group_t * g = lv_group_create();
     lv_group_set_default(g);
     lv_indev_set_group(keypad_indev, g);
@@ -816,45 +1347,38 @@ int main(void)
     lv_obj_t * screen = lv_scr_act();
     lv_obj_set_style_bg_color(screen, lv_color_hex(0x000000), LV_PART_MAIN);
 
-    time_label = lv_label_create(screen);
-    
     // 【修改点 1】颜色：改为最亮的纯白 (0xFFFFFF)，配合列表风格
-    lv_obj_set_style_text_color(time_label, lv_color_hex(0xFFFFFF), 0);
-    
-    // 【修改点 2】字体：改为 nes_font_16
-    // 原来的 montserrat_14 边缘发虚，NES 字体是像素点阵，看起来又粗又清晰
-    lv_obj_set_style_text_font(time_label, &lv_font_montserrat_16, 0); 
+    // 【修改点 2】字体：montserrat_16，字形预先混合到屏幕背景色 (0x000000) 上
+    // The clock is a sprite widget: each update only copies the changed digit cells
+    time_label = clock_sprite_create(screen, ui_font(16), lv_color_hex(0xFFFFFF), lv_color_hex(0x000000));
     
     // 调整位置：因为字体变大了，可能需要微调一下对齐，以免贴边太紧
-    lv_obj_align(time_label, LV_ALIGN_TOP_RIGHT, -8, 8); 
+    lv_obj_align(time_label, LV_ALIGN_TOP_RIGHT, ui_w(-8), ui_h(8)); 
     
-    time_update_task(NULL); 
-    lv_timer_create(time_update_task, 1000, NULL);
+    tzset();
+    time_timer = lv_timer_create(time_update_task, 1000, NULL);
+    time_update_task(NULL);
 
     create_main_menu(screen, g);
-    
-    while(1) {
-        lv_timer_handler();
-        usleep(5000);
-    }
 
-    return 0;
-}
+    idle_power_init(keypad_indev, idle_reduce_secs, idle_blank_secs);
+    idle_power_set_state_cb(idle_power_state_changed);
+    startup_mark(STARTUP_UI_BUILT);
 
-// Tick for LVGL
-uint32_t custom_tick_get(void)
-{
-    static uint64_t start_ms = 0;
-    if(start_ms == 0) {
-        struct timeval tv_start;
-        gettimeofday(&tv_start, NULL);
-        start_ms = (tv_start.tv_sec * 1000000 + tv_start.tv_usec) / 1000;
-    }
+    // Not needed for the first frame: done on idle cycles once it is out
+    startup_add_prewarm("cjk style", prewarm_cjk_style);
+    startup_add_prewarm("nes dir", prewarm_nes_dir);
+    startup_add_prewarm("stella dir", prewarm_stella_dir);
+    if (eager_init) startup_prewarm_all();
 
-    struct timeval tv_now;
-    gettimeofday(&tv_now, NULL);
-    uint64_t now_ms;
-    now_ms = (tv_now.tv_sec * 1000000 + tv_now.tv_usec) / 1000;
+    // Fonts, styles and the first screen exist now: lock them in RAM before going real-time
+    rt_sched_configure(arg_rt_priority >= 0 ? arg_rt_priority : rt_priority,
+                       arg_rt_cpu_mask ? arg_rt_cpu_mask : rt_cpu_mask);
+    if (rt_sched_apply()) rt_sched_lock_memory();
 
-    return (uint32_t)(now_ms - start_ms);
-}
\ No newline at end of file
+    watchdog_start(watchdog_threshold_cnt ? watchdog_thresholds : NULL, watchdog_threshold_cnt);
+    
+    event_loop_run();
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file rt_sched.c
+ * @brief Opt-in SCHED_FIFO mode for the render/input (main) thread.
+ */
+
+#define _GNU_SOURCE // CPU_SET, SCHED_RESET_ON_FORK
+
+#include "rt_sched.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+// Children forked while SCHED_FIFO is active start with normal scheduling
+#ifndef SCHED_RESET_ON_FORK
+#define SCHED_RESET_ON_FORK 0x40000000
+#endif
+
+static int rt_priority;
+static uint32_t rt_cpu_mask;
+
+// Threads the UI thread waits on; they follow its policy and CPU mask
+static pthread_t helpers[RT_SCHED_MAX_HELPERS];
+static int helper_cnt;
+
+static bool active;
+static bool pinned;
+static bool memory_locked;
+static bool have_orig_affinity;
+static cpu_set_t orig_affinity;
+static uint64_t suspensions;
+
+static bool set_fifo(pthread_t thread, int priority) {
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = priority;
+    int policy = priority > 0 ? (SCHED_FIFO | SCHED_RESET_ON_FORK) : SCHED_OTHER;
+
+    int err = pthread_setschedparam(thread, policy, &sp);
+    if (err == EINVAL && priority > 0) {
+        // Kernel or libc without SCHED_RESET_ON_FORK support
+        err = pthread_setschedparam(thread, SCHED_FIFO, &sp);
+    }
+    if (err != 0) {
+        fprintf(stderr, "rt_sched: cannot set %s priority %d: %s\n",
+                priority > 0 ? "SCHED_FIFO" : "SCHED_OTHER", priority, strerror(err));
+        return false;
+    }
+    return true;
+}
+
+static void pin_cpus(void) {
+    if (!rt_cpu_mask) return;
+
+    if (!have_orig_affinity) {
+        have_orig_affinity = sched_getaffinity(0, sizeof(orig_affinity), &orig_affinity) == 0;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 32; cpu++) {
+        if (rt_cpu_mask & (1u << cpu)) CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        perror("rt_sched: sched_setaffinity");
+        return;
+    }
+    pinned = true;
+    for (int i = 0; i < helper_cnt; i++) pthread_setaffinity_np(helpers[i], sizeof(set), &set);
+}
+
+static void unpin_cpus(void) {
+    if (!pinned || !have_orig_affinity) return;
+    sched_setaffinity(0, sizeof(orig_affinity), &orig_affinity);
+    for (int i = 0; i < helper_cnt; i++) pthread_setaffinity_np(helpers[i], sizeof(orig_affinity), &orig_affinity);
+    pinned = false;
+}
+
+// --- Public API ---
+void rt_sched_configure(int priority, uint32_t cpu_mask) {
+    int max = sched_get_priority_max(SCHED_FIFO);
+    if (priority < 0) priority = 0;
+    if (max > 0 && priority > max) priority = max;
+    rt_priority = priority;
+    rt_cpu_mask = cpu_mask;
+}
+
+uint32_t rt_sched_parse_cpus(const char * list) {
+    uint32_t mask = 0;
+    const char * p = list;
+    while (*p) {
+        char * end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first > 31) return 0;
+        long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first || last > 31) return 0;
+        }
+        for (long cpu = first; cpu <= last; cpu++) mask |= 1u << cpu;
+        if (*end == ',') end++;
+        else if (*end != '\0') return 0;
+        p = end;
+    }
+    return mask;
+}
+
+bool rt_sched_apply(void) {
+    if (rt_priority <= 0) return false;
+
+    // Pin only once SCHED_FIFO is granted: a refused request must not leave the mask behind,
+    // since threads and children started later would inherit it and nothing would undo it
+    active = set_fifo(pthread_self(), rt_priority);
+    if (!active) {
+        fprintf(stderr, "rt_sched: continuing with normal scheduling (needs CAP_SYS_NICE or RLIMIT_RTPRIO)\n");
+        return false;
+    }
+    // Same priority for the helpers: a FIFO UI thread blocked on a normal one would wait behind
+    // every other runnable task
+    for (int i = 0; i < helper_cnt; i++) set_fifo(helpers[i], rt_priority);
+    pin_cpus();
+    return true;
+}
+
+void rt_sched_add_thread(pthread_t thread) {
+    if (helper_cnt == RT_SCHED_MAX_HELPERS) return;
+    helpers[helper_cnt++] = thread;
+    if (!active) return;
+    set_fifo(thread, rt_priority);
+    if (pinned) {
+        cpu_set_t set;
+        sched_getaffinity(0, sizeof(set), &set);
+        pthread_setaffinity_np(thread, sizeof(set), &set);
+    }
+}
+
+void rt_sched_lock_memory(void) {
+    if (!active || memory_locked) return;
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) memory_locked = true;
+    else perror("rt_sched: mlockall");
+}
+
+void rt_sched_suspend(void) {
+    if (!active) return;
+    set_fifo(pthread_self(), 0);
+    for (int i = 0; i < helper_cnt; i++) set_fifo(helpers[i], 0);
+    unpin_cpus();
+    active = false;
+    suspensions++;
+}
+
+void rt_sched_resume(void) {
+    if (active || rt_priority <= 0) return;
+    rt_sched_apply();
+}
+
+int rt_sched_system(const char * command) {
+    bool was_active = active;
+    rt_sched_suspend();
+    int ret = system(command);
+    if (was_active) rt_sched_resume();
+    return ret;
+}
+
+bool rt_sched_is_active(void) {
+    return active;
+}
+
+void rt_sched_dump_stats(FILE * out) {
+    fprintf(out, "[rt] mode %s (priority %d, cpu mask 0x%x%s), mlock %s, suspensions %llu\n",
+            active ? "SCHED_FIFO" : "normal", rt_priority, rt_cpu_mask, pinned ? " pinned" : "",
+            memory_locked ? "yes" : "no", (unsigned long long)suspensions);
+}
@@ -0,0 +1,68 @@
+/**
+ * @file rt_sched.h
+ * @brief Opt-in SCHED_FIFO mode for the render/input (main) thread.
+ */
+
+#ifndef RT_SCHED_H
+#define RT_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#define RT_SCHED_DEFAULT_PRIORITY 10
+#define RT_SCHED_MAX_HELPERS 4
+
+// Stack size for the menu's own threads. mlockall() keeps every thread stack resident, and the
+// 8 MiB default would pin several times the whole UI's memory on a 64 MB board.
+#define RT_SCHED_THREAD_STACK_SIZE (128 * 1024)
+
+/**
+ * Select the mode. Nothing is applied until rt_sched_apply().
+ * @param priority SCHED_FIFO priority (1..99), 0 keeps normal scheduling
+ * @param cpu_mask CPUs the main thread is pinned to (bit n = CPU n), 0 = no pinning
+ */
+void rt_sched_configure(int priority, uint32_t cpu_mask);
+
+/**
+ * Parse a CPU list such as "0", "0,2" or "0-1" into a mask.
+ * @return the mask, 0 if the list is malformed
+ */
+uint32_t rt_sched_parse_cpus(const char * list);
+
+/**
+ * Switch the calling thread to the configured policy and affinity.
+ * Fails gracefully (warning, normal scheduling) without CAP_SYS_NICE.
+ * @return true if SCHED_FIFO is active afterwards
+ */
+bool rt_sched_apply(void);
+
+/**
+ * Let a helper the main thread depends on (flush worker, input capture) follow its mode: it gets
+ * the same priority and CPU mask in rt_sched_apply() and drops back in rt_sched_suspend().
+ * May be called before or after rt_sched_apply(). Main thread only.
+ */
+void rt_sched_add_thread(pthread_t thread);
+
+/**
+ * mlockall() the process. Call once the fonts, styles and first screen exist.
+ */
+void rt_sched_lock_memory(void);
+
+/**
+ * Drop back to normal scheduling and the original CPU set, e.g. while an emulator owns the screen.
+ */
+void rt_sched_suspend(void);
+void rt_sched_resume(void);
+
+/**
+ * system() with the main thread temporarily back at normal priority, so the
+ * child and anything it spawns are not starved or pinned.
+ */
+int rt_sched_system(const char * command);
+
+bool rt_sched_is_active(void);
+void rt_sched_dump_stats(FILE * out);
+
+#endif // RT_SCHED_H
@@ -0,0 +1,110 @@
+/**
+ * @file startup.c
+ * @brief Startup timeline (exec -> lv_init -> first flush -> idle) and deferred pre-warm work.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "startup.h"
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+typedef struct {
+    const char * name;
+    startup_task_t task;
+    uint32_t us;   // Time the task took
+} prewarm_t;
+
+static const char * const mark_names[STARTUP_MARK_CNT] = {
+    "exec", "main", "lv_init", "ui built", "first flush", "first frame", "idle", "prewarmed"
+};
+
+// CLOCK_BOOTTIME in us, 0 = not reached yet
+static uint64_t marks[STARTUP_MARK_CNT];
+
+static prewarm_t tasks[STARTUP_MAX_PREWARM];
+static int task_cnt;
+static int task_next;
+
+// --- Helper Functions ---
+static uint64_t boottime_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// Field 22 of /proc/self/stat is the start time in clock ticks since boot
+static uint64_t exec_time_us(void) {
+    char buf[512];
+    FILE * fp = fopen("/proc/self/stat", "r");
+    if (!fp) return 0;
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[n] = '\0';
+
+    // The command name may contain spaces; fields are counted after its closing ')'
+    char * p = strrchr(buf, ')');
+    if (!p) return 0;
+    unsigned long long start = 0;
+    if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+               &start) != 1) return 0;
+
+    long hz = sysconf(_SC_CLK_TCK);
+    return hz > 0 ? start * 1000000ULL / hz : 0;
+}
+
+static void run_task(prewarm_t * t) {
+    uint64_t t0 = boottime_us();
+    t->task();
+    t->us = (uint32_t)(boottime_us() - t0);
+}
+
+// --- Public API ---
+void startup_mark(startup_mark_t mark) {
+    if (mark >= STARTUP_MARK_CNT || marks[mark]) return;
+    marks[mark] = boottime_us();
+    if (mark == STARTUP_MAIN) marks[STARTUP_EXEC] = exec_time_us();
+    if (mark == STARTUP_IDLE) startup_dump_timeline(stderr);
+}
+
+void startup_add_prewarm(const char * name, startup_task_t task) {
+    if (task_cnt >= STARTUP_MAX_PREWARM) return;
+    tasks[task_cnt].name = name;
+    tasks[task_cnt].task = task;
+    task_cnt++;
+}
+
+void startup_prewarm_all(void) {
+    while (task_next < task_cnt) run_task(&tasks[task_next++]);
+    startup_mark(STARTUP_PREWARMED);
+}
+
+bool startup_idle(void) {
+    if (!marks[STARTUP_FIRST_FRAME]) return false;
+    startup_mark(STARTUP_IDLE);
+    if (task_next >= task_cnt) return false;
+
+    run_task(&tasks[task_next++]);
+    if (task_next < task_cnt) return true;
+
+    startup_mark(STARTUP_PREWARMED);
+    startup_dump_timeline(stderr);
+    return false;
+}
+
+void startup_dump_timeline(FILE * out) {
+    uint64_t base = marks[STARTUP_EXEC] ? marks[STARTUP_EXEC] : marks[STARTUP_MAIN];
+    const char * sep = "";
+    fprintf(out, "[startup]");
+    for (int i = 0; i < STARTUP_MARK_CNT; i++) {
+        if (!marks[i]) continue;
+        fprintf(out, "%s %s %.1f ms", sep, mark_names[i], (marks[i] - base) / 1000.0);
+        sep = ",";
+    }
+    fprintf(out, "\n");
+
+    for (int i = 0; i < task_next; i++) {
+        fprintf(out, "[startup] prewarm %-12s %.2f ms\n", tasks[i].name, tasks[i].us / 1000.0);
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * @file startup.h
+ * @brief Startup timeline (exec -> lv_init -> first flush -> idle) and deferred pre-warm work.
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define STARTUP_MAX_PREWARM 8
+
+typedef enum {
+    STARTUP_EXEC = 0,      // Process start (from /proc/self/stat, clock tick resolution)
+    STARTUP_MAIN,          // main() entered
+    STARTUP_LV_INIT,       // lv_init() returned
+    STARTUP_UI_BUILT,      // First screen constructed
+    STARTUP_FIRST_FLUSH,   // First flush_cb call
+    STARTUP_FIRST_FRAME,   // First refresh finished
+    STARTUP_IDLE,          // Main loop about to sleep for the first time after the first frame
+    STARTUP_PREWARMED,     // All pre-warm tasks done
+    STARTUP_MARK_CNT
+} startup_mark_t;
+
+typedef void (*startup_task_t)(void);
+
+/**
+ * Record a point on the timeline. Only the first call for each mark counts.
+ */
+void startup_mark(startup_mark_t mark);
+
+/**
+ * Queue work that is not needed for the first frame. Tasks run one per idle
+ * main loop cycle after the first frame, in the order they were added.
+ */
+void startup_add_prewarm(const char * name, startup_task_t task);
+
+/**
+ * Run every queued task now (eager startup, e.g. to compare timelines).
+ */
+void startup_prewarm_all(void);
+
+/**
+ * Called by the main loop before it blocks. Marks STARTUP_IDLE and runs one pre-warm task.
+ * @return true if more tasks are pending, i.e. the loop should only poll
+ */
+bool startup_idle(void);
+
+/**
+ * Print the timeline in ms since exec.
+ */
+void startup_dump_timeline(FILE * out);
+
+#endif // STARTUP_H
@@ -0,0 +1,99 @@
+/**
+ * @file tick.c
+ * @brief Monotonic time base for LVGL and the rest of the app.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "tick.h"
+#include "ui_queue.h"
+#include <time.h>
+#include <stdbool.h>
+
+// How often (in ms of monotonic time) the wall clock is compared against the monotonic clock
+#define WALL_CHECK_PERIOD_MS 1000
+// Wall/monotonic disagreement above this is reported as a wall-clock jump
+#define WALL_JUMP_MIN_MS 500
+
+static uint64_t start_us;
+static uint64_t last_read_us;
+static bool idle_marked;
+static tick_stats_t stats;
+
+// Wall clock minus monotonic clock at the last check, in ms
+static int64_t wall_offset_ms;
+static uint64_t last_wall_check_ms;
+
+static uint64_t ts_to_us(const struct timespec * ts) {
+    return (uint64_t)ts->tv_sec * 1000000ULL + (uint64_t)ts->tv_nsec / 1000ULL;
+}
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts_to_us(&ts);
+}
+
+static int64_t read_wall_offset_ms(uint64_t mono_us) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)(ts_to_us(&ts) / 1000ULL) - (int64_t)(mono_us / 1000ULL);
+}
+
+uint64_t tick_get_us(void) {
+    uint64_t now = monotonic_us();
+    if (start_us == 0) {
+        start_us = now;
+        last_read_us = now;
+        wall_offset_ms = read_wall_offset_ms(now);
+    }
+    return now - start_us;
+}
+
+uint64_t tick_get_ms64(void) {
+    return tick_get_us() / 1000ULL;
+}
+
+uint32_t custom_tick_get(void) {
+    // LVGL reads the tick from timers, animations, input and refresh code, so this
+    // catches most LVGL entry points used from a worker thread
+    UI_ASSERT_THREAD();
+
+    uint64_t now_us = tick_get_us();
+    uint64_t abs_us = now_us + start_us;
+
+    uint32_t gap_ms = (uint32_t)((abs_us - last_read_us) / 1000ULL);
+    last_read_us = abs_us;
+    stats.reads++;
+    if (!idle_marked) {
+        if (gap_ms > stats.max_gap_ms) stats.max_gap_ms = gap_ms;
+        if (gap_ms > TICK_OVERRUN_MS) {
+            stats.overruns++;
+            stats.last_gap_ms = gap_ms;
+        }
+    }
+    idle_marked = false;
+
+    // The LVGL tick never looks at the wall clock; this only records that it moved
+    uint64_t now_ms = now_us / 1000ULL;
+    if (now_ms - last_wall_check_ms >= WALL_CHECK_PERIOD_MS) {
+        last_wall_check_ms = now_ms;
+        int64_t offset = read_wall_offset_ms(abs_us);
+        int64_t step = offset - wall_offset_ms;
+        if (step > WALL_JUMP_MIN_MS || step < -WALL_JUMP_MIN_MS) {
+            stats.wall_jumps++;
+            stats.wall_jump_ms += step;
+        }
+        wall_offset_ms = offset;
+    }
+
+    return (uint32_t)now_ms;
+}
+
+void tick_mark_idle(void) {
+    idle_marked = true;
+}
+
+void tick_get_stats(tick_stats_t * out) {
+    *out = stats;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file tick.h
+ * @brief Monotonic time base for LVGL and the rest of the app.
+ *
+ * All values count from the first call and are unaffected by `date -s`,
+ * hwclock or NTP steps of the wall clock.
+ */
+
+#ifndef TICK_H
+#define TICK_H
+
+#include <stdint.h>
+
+// A busy gap between two tick reads longer than this counts as an overrun
+#ifndef TICK_OVERRUN_MS
+#define TICK_OVERRUN_MS 100
+#endif
+
+typedef struct {
+    uint64_t reads;          // Number of custom_tick_get() calls
+    uint64_t overruns;       // Busy gaps longer than TICK_OVERRUN_MS
+    uint32_t max_gap_ms;     // Longest busy gap seen between two reads
+    uint32_t last_gap_ms;    // Most recent busy gap that was an overrun
+    uint64_t wall_jumps;     // Wall-clock steps detected (and ignored)
+    int64_t  wall_jump_ms;   // Sum of those steps, signed
+} tick_stats_t;
+
+/**
+ * LVGL tick (LV_TICK_CUSTOM_SYS_TIME_EXPR). Milliseconds, wraps after ~49 days.
+ */
+uint32_t custom_tick_get(void);
+
+uint64_t tick_get_ms64(void);
+uint64_t tick_get_us(void);
+
+/**
+ * Tell the tick source the main thread is about to sleep on purpose,
+ * so the next gap is not counted as an overrun.
+ */
+void tick_mark_idle(void);
+
+void tick_get_stats(tick_stats_t * stats);
+
+#endif // TICK_H
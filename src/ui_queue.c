@@ -0,0 +1,151 @@
+/**
+ * @file ui_queue.c
+ * @brief Lets background threads post work to the LVGL (UI) thread.
+ *
+ * Bounded MPSC queue with a sequence number per slot: producers claim a slot by CAS on the
+ * enqueue position and publish it by advancing the slot's sequence; the single consumer
+ * reads slots in order.
+ */
+
+#define _GNU_SOURCE
+
+#include "ui_queue.h"
+#include "tick.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+typedef struct {
+    volatile uint32_t seq;
+    ui_queue_fn_t fn;
+    void * arg;
+} ui_queue_slot_t;
+
+static ui_queue_slot_t slots[UI_QUEUE_SIZE];
+static volatile uint32_t enqueue_pos;
+static uint32_t dequeue_pos;   // Consumer only
+
+static int wake_fd = -1;
+static pthread_t ui_thread;
+static bool initialized;
+
+// Producer side counters are updated atomically
+static volatile uint64_t posted;
+static volatile uint64_t rejected;
+static volatile uint32_t max_depth;
+static ui_queue_stats_t stats;
+
+bool ui_queue_init(void) {
+    for (uint32_t i = 0; i < UI_QUEUE_SIZE; i++) slots[i].seq = i;
+
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        perror("ui_queue: eventfd");
+        return false;
+    }
+    ui_thread = pthread_self();
+    initialized = true;
+    return true;
+}
+
+int ui_queue_get_wake_fd(void) {
+    return wake_fd;
+}
+
+bool ui_queue_post(ui_queue_fn_t fn, void * arg) {
+    uint32_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    ui_queue_slot_t * slot;
+
+    while (1) {
+        slot = &slots[pos & (UI_QUEUE_SIZE - 1)];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int32_t dif = (int32_t)(seq - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            __atomic_add_fetch(&rejected, 1, __ATOMIC_RELAXED);
+            return false;
+        } else {
+            pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->fn = fn;
+    slot->arg = arg;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&posted, 1, __ATOMIC_RELAXED);
+    uint32_t depth = pos + 1 - __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    uint32_t seen = __atomic_load_n(&max_depth, __ATOMIC_RELAXED);
+    while (depth > seen && !__atomic_compare_exchange_n(&max_depth, &seen, depth, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+
+    uint64_t one = 1;
+    write(wake_fd, &one, sizeof(one));
+    return true;
+}
+
+static bool pop(ui_queue_slot_t * out) {
+    ui_queue_slot_t * slot = &slots[dequeue_pos & (UI_QUEUE_SIZE - 1)];
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if ((int32_t)(seq - (dequeue_pos + 1)) < 0) return false;
+
+    out->fn = slot->fn;
+    out->arg = slot->arg;
+    __atomic_store_n(&slot->seq, dequeue_pos + UI_QUEUE_SIZE, __ATOMIC_RELEASE);
+    __atomic_store_n(&dequeue_pos, dequeue_pos + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+void ui_queue_drain(uint32_t budget_us) {
+    UI_ASSERT_THREAD();
+
+    uint64_t cnt;
+    read(wake_fd, &cnt, sizeof(cnt));
+
+    uint64_t start = tick_get_us();
+    ui_queue_slot_t msg;
+    while (pop(&msg)) {
+        msg.fn(msg.arg);
+        stats.executed++;
+
+        if (tick_get_us() - start >= budget_us) {
+            // Leave the rest for the next frame, but make sure the loop comes back
+            uint32_t pending = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED) - dequeue_pos;
+            if (pending) {
+                stats.budget_hits++;
+                uint64_t one = 1;
+                write(wake_fd, &one, sizeof(one));
+            }
+            break;
+        }
+    }
+
+    uint32_t took = (uint32_t)(tick_get_us() - start);
+    if (took > stats.max_drain_us) stats.max_drain_us = took;
+}
+
+bool ui_queue_is_ui_thread(void) {
+    return !initialized || pthread_equal(pthread_self(), ui_thread);
+}
+
+void ui_queue_assert_ui_thread(const char * where) {
+    if (ui_queue_is_ui_thread()) return;
+    fprintf(stderr, "[ui_queue] LVGL used off the UI thread in %s\n", where);
+    abort();
+}
+
+void ui_queue_get_stats(ui_queue_stats_t * out) {
+    *out = stats;
+    out->posted = __atomic_load_n(&posted, __ATOMIC_RELAXED);
+    out->rejected = __atomic_load_n(&rejected, __ATOMIC_RELAXED);
+    out->max_depth = __atomic_load_n(&max_depth, __ATOMIC_RELAXED);
+}
+
+void ui_queue_dump_stats(FILE * out) {
+    ui_queue_stats_t s;
+    ui_queue_get_stats(&s);
+    fprintf(out, "[ui_queue] posted %llu, executed %llu, rejected %llu, max depth %u/%u, budget hits %llu, max drain %u us\n",
+            (unsigned long long)s.posted, (unsigned long long)s.executed, (unsigned long long)s.rejected,
+            s.max_depth, UI_QUEUE_SIZE, (unsigned long long)s.budget_hits, s.max_drain_us);
+}
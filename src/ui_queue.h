@@ -0,0 +1,77 @@
+/**
+ * @file ui_queue.h
+ * @brief Lets background threads post work to the LVGL (UI) thread.
+ *
+ * Workers post closures into a bounded lock-free MPSC queue; an eventfd wakes the main loop,
+ * which drains the queue once per frame within a time budget. LVGL is not thread-safe:
+ * everything that touches LVGL objects must run through here.
+ */
+
+#ifndef UI_QUEUE_H
+#define UI_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Queue capacity in messages, must be a power of two
+#define UI_QUEUE_SIZE 64
+// Max time spent draining per frame
+#define UI_QUEUE_BUDGET_US 2000
+
+// Debug builds (make EXTRA_CFLAGS=-DUI_THREAD_ASSERT=1) abort on LVGL use off the UI thread
+#ifndef UI_THREAD_ASSERT
+#define UI_THREAD_ASSERT 0
+#endif
+
+typedef void (*ui_queue_fn_t)(void * arg);
+
+typedef struct {
+    uint64_t posted;         // Accepted messages
+    uint64_t rejected;       // Refused because the queue was full
+    uint64_t executed;
+    uint64_t budget_hits;    // Drains stopped by the time budget with messages left
+    uint32_t max_depth;      // Deepest queue seen by a producer
+    uint32_t max_drain_us;
+} ui_queue_stats_t;
+
+/**
+ * Create the wake eventfd and record the calling thread as the UI thread.
+ * Call from the main thread before any worker posts.
+ */
+bool ui_queue_init(void);
+
+/**
+ * eventfd that becomes readable when messages are pending. Register it with
+ * the event loop and call ui_queue_drain() from its callback.
+ */
+int ui_queue_get_wake_fd(void);
+
+/**
+ * Post `fn(arg)` to run on the UI thread. Safe from any thread.
+ * @return false if the queue is full; the caller keeps ownership of `arg`
+ */
+bool ui_queue_post(ui_queue_fn_t fn, void * arg);
+
+/**
+ * Run pending messages until the queue is empty or the budget is spent. UI thread only.
+ */
+void ui_queue_drain(uint32_t budget_us);
+
+bool ui_queue_is_ui_thread(void);
+
+/**
+ * Abort with a message if the caller is not the UI thread (UI_THREAD_ASSERT builds only).
+ */
+void ui_queue_assert_ui_thread(const char * where);
+
+void ui_queue_get_stats(ui_queue_stats_t * stats);
+void ui_queue_dump_stats(FILE * out);
+
+#if UI_THREAD_ASSERT
+#define UI_ASSERT_THREAD() ui_queue_assert_ui_thread(__func__)
+#else
+#define UI_ASSERT_THREAD() do {} while(0)
+#endif
+
+#endif // UI_QUEUE_H
@@ -0,0 +1,215 @@
+/**
+ * @file watchdog.c
+ * @brief Main loop stall detector: logs stalls with a backtrace of the main thread and keeps a histogram.
+ *
+ * The main loop publishes the start of each busy period. The watchdog thread sleeps until the
+ * next threshold of the current period would be crossed and, if the period is still running,
+ * reports it and sends SIGUSR2 to the main thread, whose handler prints a backtrace.
+ * While the main loop is idle the watchdog thread blocks on a semaphore and costs nothing.
+ */
+
+#define _GNU_SOURCE
+
+#include "watchdog.h"
+#include "tick.h"
+#include "rt_sched.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#if defined(__GLIBC__) || defined(__UCLIBC_HAS_BACKTRACE__)
+#define WATCHDOG_HAVE_BACKTRACE 1
+#include <execinfo.h>
+#else
+#define WATCHDOG_HAVE_BACKTRACE 0
+#endif
+
+#define WATCHDOG_SIGNAL SIGUSR2
+#define BACKTRACE_DEPTH 32
+
+static const uint32_t default_thresholds[] = {50, 250, 1000};
+static const uint32_t hist_bucket_ms[WATCHDOG_HIST_BUCKETS - 1] = {100, 250, 500, 1000, 5000};
+
+static uint32_t thresholds[WATCHDOG_MAX_THRESHOLDS];
+static int threshold_cnt;
+
+static pthread_t main_thread;
+static pthread_t wd_thread;
+static sem_t wake_sem;
+
+// Shared with the watchdog thread
+static volatile uint32_t busy_since_ms;   // Start of the current busy period, 0 while idle
+static volatile uint32_t beat_seq;        // Incremented for every busy period
+static volatile int parked;               // The watchdog waits on wake_sem
+
+// Only written by the main thread
+static watchdog_stats_t stats;
+
+// --- Signal Handler (main thread) ---
+static void backtrace_handler(int sig) {
+    static const char hdr[] = "[watchdog] main thread backtrace:\n";
+    write(STDERR_FILENO, hdr, sizeof(hdr) - 1);
+#if WATCHDOG_HAVE_BACKTRACE
+    void * frames[BACKTRACE_DEPTH];
+    int n = backtrace(frames, BACKTRACE_DEPTH);
+    backtrace_symbols_fd(frames, n, STDERR_FILENO);
+#else
+    static const char na[] = "  (backtrace() not available in this libc)\n";
+    write(STDERR_FILENO, na, sizeof(na) - 1);
+#endif
+}
+
+// --- Watchdog Thread ---
+static void sleep_until_ms(uint32_t target_ms) {
+    uint32_t now = (uint32_t)tick_get_ms64();
+    int32_t left = (int32_t)(target_ms - now);
+    if (left <= 0) return;
+    struct timespec ts = { left / 1000, (left % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+static void * watchdog_thread(void * arg) {
+    while (1) {
+        uint32_t since = __atomic_load_n(&busy_since_ms, __ATOMIC_ACQUIRE);
+        if (since == 0) {
+            __atomic_store_n(&parked, 1, __ATOMIC_SEQ_CST);
+            // Re-check after announcing we park, so a beat in between is not lost
+            if (__atomic_load_n(&busy_since_ms, __ATOMIC_SEQ_CST) == 0) {
+                while (sem_wait(&wake_sem) != 0 && errno == EINTR) {}
+            }
+            __atomic_store_n(&parked, 0, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        uint32_t seq = __atomic_load_n(&beat_seq, __ATOMIC_ACQUIRE);
+        for (int level = 0; level < threshold_cnt; level++) {
+            sleep_until_ms(since + thresholds[level]);
+            if (__atomic_load_n(&beat_seq, __ATOMIC_ACQUIRE) != seq ||
+                __atomic_load_n(&busy_since_ms, __ATOMIC_ACQUIRE) != since) break;
+
+            fprintf(stderr, "[watchdog] main loop stalled for more than %u ms\n", thresholds[level]);
+            pthread_kill(main_thread, WATCHDOG_SIGNAL);
+        }
+
+        // Wait for this busy period to end before looking at the next one
+        while (__atomic_load_n(&beat_seq, __ATOMIC_ACQUIRE) == seq &&
+               __atomic_load_n(&busy_since_ms, __ATOMIC_ACQUIRE) == since) {
+            sleep_until_ms((uint32_t)tick_get_ms64() + thresholds[threshold_cnt - 1]);
+        }
+    }
+    return NULL;
+}
+
+// --- Main Thread Side ---
+static void end_period(uint32_t now) {
+    uint32_t since = busy_since_ms;
+    if (since == 0) return;
+
+    uint32_t dur = now - since;
+    if (dur > stats.max_ms) stats.max_ms = dur;
+    for (int level = 0; level < threshold_cnt; level++) {
+        if (dur >= thresholds[level]) stats.stalls[level]++;
+    }
+    if (threshold_cnt && dur >= thresholds[0]) {
+        int b = 0;
+        while (b < WATCHDOG_HIST_BUCKETS - 1 && dur >= hist_bucket_ms[b]) b++;
+        stats.hist[b]++;
+    }
+}
+
+void watchdog_beat(void) {
+    if (!threshold_cnt) return;
+
+    uint32_t now = (uint32_t)tick_get_ms64();
+    end_period(now);
+    __atomic_store_n(&busy_since_ms, now ? now : 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&beat_seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&parked, __ATOMIC_SEQ_CST)) sem_post(&wake_sem);
+}
+
+void watchdog_idle(void) {
+    if (!threshold_cnt) return;
+
+    end_period((uint32_t)tick_get_ms64());
+    __atomic_store_n(&busy_since_ms, 0, __ATOMIC_RELEASE);
+}
+
+bool watchdog_start(const uint32_t * list, int count) {
+    if (!list || count <= 0) {
+        list = default_thresholds;
+        count = sizeof(default_thresholds) / sizeof(default_thresholds[0]);
+    }
+    if (count > WATCHDOG_MAX_THRESHOLDS) count = WATCHDOG_MAX_THRESHOLDS;
+    memcpy(thresholds, list, count * sizeof(uint32_t));
+
+    main_thread = pthread_self();
+    sem_init(&wake_sem, 0, 0);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = backtrace_handler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(WATCHDOG_SIGNAL, &sa, NULL);
+
+#if WATCHDOG_HAVE_BACKTRACE
+    // The first backtrace() call may load libgcc_s; do it now, not inside the signal handler
+    void * frames[2];
+    backtrace(frames, 2);
+#endif
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, RT_SCHED_THREAD_STACK_SIZE);
+    int err = pthread_create(&wd_thread, &attr, watchdog_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        perror("watchdog: pthread_create");
+        return false;
+    }
+    // Try to outrank a SCHED_FIFO main thread; silently stays normal without CAP_SYS_NICE
+    struct sched_param sp = { .sched_priority = sched_get_priority_max(SCHED_FIFO) };
+    pthread_setschedparam(wd_thread, SCHED_FIFO, &sp);
+
+    threshold_cnt = count;
+    return true;
+}
+
+int watchdog_parse_thresholds(const char * list, uint32_t * out, int max) {
+    int n = 0;
+    const char * p = list;
+    while (*p && n < max) {
+        char * end;
+        long v = strtol(p, &end, 10);
+        if (end == p || v <= 0 || (n > 0 && (uint32_t)v <= out[n - 1])) return 0;
+        out[n++] = (uint32_t)v;
+        if (*end == ',') end++;
+        else if (*end != '\0') return 0;
+        p = end;
+    }
+    return *p ? 0 : n;
+}
+
+void watchdog_get_stats(watchdog_stats_t * out) {
+    *out = stats;
+}
+
+void watchdog_dump_stats(FILE * out) {
+    if (!threshold_cnt) return;
+
+    fprintf(out, "[watchdog] longest busy period %u ms; stalls:", stats.max_ms);
+    for (int level = 0; level < threshold_cnt; level++) {
+        fprintf(out, " >=%ums:%llu", thresholds[level], (unsigned long long)stats.stalls[level]);
+    }
+    fprintf(out, "\n[watchdog] stall histogram:");
+    for (int b = 0; b < WATCHDOG_HIST_BUCKETS; b++) {
+        if (b < WATCHDOG_HIST_BUCKETS - 1) fprintf(out, " <%ums:%llu", hist_bucket_ms[b], (unsigned long long)stats.hist[b]);
+        else fprintf(out, " >=%ums:%llu", hist_bucket_ms[b - 1], (unsigned long long)stats.hist[b]);
+    }
+    fprintf(out, "\n");
+}
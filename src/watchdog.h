@@ -0,0 +1,49 @@
+/**
+ * @file watchdog.h
+ * @brief Main loop stall detector: logs stalls with a backtrace of the main thread and keeps a histogram.
+ */
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define WATCHDOG_MAX_THRESHOLDS 4
+#define WATCHDOG_HIST_BUCKETS 6
+
+typedef struct {
+    uint64_t stalls[WATCHDOG_MAX_THRESHOLDS];   // Busy periods that crossed each threshold
+    uint64_t hist[WATCHDOG_HIST_BUCKETS];       // Durations of busy periods above the first threshold
+    uint32_t max_ms;                            // Longest finished busy period
+} watchdog_stats_t;
+
+/**
+ * Start the watchdog thread. Must be called from the main (LVGL) thread,
+ * which is the one that gets sampled for backtraces.
+ * @param thresholds_ms ascending stall thresholds, NULL for the default 50/250/1000 ms
+ * @param count number of thresholds (at most WATCHDOG_MAX_THRESHOLDS)
+ */
+bool watchdog_start(const uint32_t * thresholds_ms, int count);
+
+/**
+ * Parse a threshold list such as "50,250,1000".
+ * @return number of thresholds parsed, 0 if the list is malformed
+ */
+int watchdog_parse_thresholds(const char * list, uint32_t * out, int max);
+
+/**
+ * Main loop heartbeat: a new busy period starts now.
+ */
+void watchdog_beat(void);
+
+/**
+ * The main loop is about to block on purpose; the busy period ends.
+ */
+void watchdog_idle(void);
+
+void watchdog_get_stats(watchdog_stats_t * stats);
+void watchdog_dump_stats(FILE * out);
+
+#endif // WATCHDOG_H